@@ -0,0 +1,202 @@
+//
+// Hashed IPP attribute lookups for libppd.
+//
+// Copyright © 2026 by OpenPrinting.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "ipp-private.h"
+#include "string-private.h"
+#include "libcups2-private.h"
+#include "debug-internal.h"
+
+
+//
+// Constants...
+//
+
+#define _PPD_IPP_INDEX_HASHSIZE	1024	// Size of attribute hash table
+
+
+//
+// Types...
+//
+
+typedef struct _ppd_ipp_entry_s		// **** Indexed attribute ****
+{
+  const char		*name;		// Attribute name
+  ipp_attribute_t	*attr;		// Attribute
+} _ppd_ipp_entry_t;
+
+struct _ppd_ipp_index_s			// **** Attribute index ****
+{
+  ipp_t			*ipp;		// Indexed attributes
+  cups_array_t		*entries;	// Attributes sorted by name
+  _ppd_ipp_entry_t	*storage;	// Storage for entries
+};
+
+
+//
+// Local functions...
+//
+
+static int	ppd_compare_entries(_ppd_ipp_entry_t *a, _ppd_ipp_entry_t *b);
+static int	ppd_hash_entry(_ppd_ipp_entry_t *e, void *data);
+
+
+//
+// '_ppdIppIndexDelete()' - Free an attribute index.
+//
+
+void
+_ppdIppIndexDelete(
+    _ppd_ipp_index_t *attr_index)	// I - Attribute index
+{
+  if (!attr_index)
+    return;
+
+  cupsArrayDelete(attr_index->entries);
+  free(attr_index->storage);
+  free(attr_index);
+}
+
+
+//
+// '_ppdIppIndexFind()' - Find an attribute using an attribute index.
+//
+// This returns the same attribute as ippFindAttribute() would, but
+// without walking the whole attribute list.  The index does not follow
+// changes of the IPP message, so it must only be used while the message
+// is not modified.
+//
+
+ipp_attribute_t *			// O - Matching attribute or `NULL`
+_ppdIppIndexFind(
+    _ppd_ipp_index_t *attr_index,	// I - Attribute index
+    const char       *name,		// I - Name of attribute
+    ipp_tag_t        type)		// I - Type of attribute
+{
+  _ppd_ipp_entry_t	key,		// Search key
+			*e;		// Current entry
+  ipp_tag_t		value_tag;	// Value tag of attribute
+
+
+  if (!attr_index || !name)
+    return (NULL);
+
+  //
+  // Paths into collections ("media-col/media-size") are not indexed...
+  //
+
+  if (!attr_index->entries || strchr(name, '/'))
+    return (ippFindAttribute(attr_index->ipp, name, type));
+
+  type     = (ipp_tag_t)(type & IPP_TAG_CUPS_MASK);
+  key.name = name;
+
+  for (e = (_ppd_ipp_entry_t *)cupsArrayFind(attr_index->entries, &key);
+       e && !_ppd_strcasecmp(e->name, name);
+       e = (_ppd_ipp_entry_t *)cupsArrayGetNext(attr_index->entries))
+  {
+    value_tag = ippGetValueTag(e->attr);
+
+    if (value_tag == type || type == IPP_TAG_ZERO ||
+        (value_tag == IPP_TAG_TEXTLANG && type == IPP_TAG_TEXT) ||
+        (value_tag == IPP_TAG_NAMELANG && type == IPP_TAG_NAME))
+      return (e->attr);
+  }
+
+  return (NULL);
+}
+
+
+//
+// '_ppdIppIndexNew()' - Create an index of the attributes in an IPP message.
+//
+
+_ppd_ipp_index_t *			// O - Attribute index or `NULL` on error
+_ppdIppIndexNew(ipp_t *ipp)		// I - IPP message
+{
+  _ppd_ipp_index_t	*attr_index;	// Attribute index
+  ipp_attribute_t	*attr;		// Current attribute
+  _ppd_ipp_entry_t	*e;		// Current entry
+  size_t		count;		// Number of attributes
+
+
+  if (!ipp || (attr_index = calloc(1, sizeof(_ppd_ipp_index_t))) == NULL)
+    return (NULL);
+
+  attr_index->ipp = ipp;
+
+  for (count = 0, attr = ippGetFirstAttribute(ipp);
+       attr;
+       attr = ippGetNextAttribute(ipp))
+    count ++;
+
+  //
+  // If we can't build the index, _ppdIppIndexFind() falls back to
+  // ippFindAttribute()...
+  //
+
+  if (count == 0 ||
+      (attr_index->storage = calloc(count,
+                                    sizeof(_ppd_ipp_entry_t))) == NULL ||
+      (attr_index->entries =
+           cupsArrayNew((cups_array_cb_t)ppd_compare_entries, NULL,
+	                (cups_ahash_cb_t)ppd_hash_entry,
+			_PPD_IPP_INDEX_HASHSIZE, NULL, NULL)) == NULL)
+    return (attr_index);
+
+  //
+  // Add the attributes in message order; attributes with the same name are
+  // kept in that order so that the first one is found first...
+  //
+
+  for (e = attr_index->storage, attr = ippGetFirstAttribute(ipp);
+       attr && e < attr_index->storage + count;
+       attr = ippGetNextAttribute(ipp))
+  {
+    if ((e->name = ippGetName(attr)) == NULL)
+      continue;
+
+    e->attr = attr;
+
+    cupsArrayAdd(attr_index->entries, e);
+    e ++;
+  }
+
+  return (attr_index);
+}
+
+
+//
+// 'ppd_compare_entries()' - Compare the names of two indexed attributes.
+//
+
+static int				// O - Result of comparison
+ppd_compare_entries(
+    _ppd_ipp_entry_t *a,		// I - First entry
+    _ppd_ipp_entry_t *b)		// I - Second entry
+{
+  return (_ppd_strcasecmp(a->name, b->name));
+}
+
+
+//
+// 'ppd_hash_entry()' - Compute the hash of an attribute name.
+//
+
+static int				// O - Hash value
+ppd_hash_entry(_ppd_ipp_entry_t *e,	// I - Entry
+               void             *data)	// I - Callback data (unused)
+{
+  (void)data;
+
+  return ((int)(_ppdHashString(e->name, 1) % _PPD_IPP_INDEX_HASHSIZE));
+}
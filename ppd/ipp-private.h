@@ -44,6 +44,9 @@ typedef struct _ppd_ipp_option_s	// **** Attribute mapping data ****
   const ipp_op_t *operations;		// Allowed operations for this attr
 } _ppd_ipp_option_t;
 
+typedef struct _ppd_ipp_index_s _ppd_ipp_index_t;
+					// **** Hashed attribute index ****
+
 //
 // Prototypes for private functions...
 //
@@ -51,6 +54,15 @@ typedef struct _ppd_ipp_option_s	// **** Attribute mapping data ****
 // encode.c
 extern _ppd_ipp_option_t	*_ppdIppFindOption(const char *name);
 
+// ipp-index.c
+extern void		_ppdIppIndexDelete(_ppd_ipp_index_t *attr_index);
+extern ipp_attribute_t	*_ppdIppIndexFind(_ppd_ipp_index_t *attr_index,
+					  const char *name, ipp_tag_t type);
+extern _ppd_ipp_index_t	*_ppdIppIndexNew(ipp_t *ipp);
+
+// ppd-generator.c
+extern unsigned		_ppdGeneratedHits(void);
+
 
 //
 // C++ magic...
@@ -10,7 +10,9 @@
 //
 // Contents:
 //
+//   prefix_gets()          - Get a line from the beginning of the input
 //   parsePDFTOPDFComment() - Check whether we are executed after pdftopdf
+//   is_empty()             - Check whether the input has no pages
 //   remove_options()       - Remove unwished entries from an option list
 //   log_command_line()     - Log the command line of a program which we call
 //   ppdFilterPDFToPS()     - pdftops filter function
@@ -37,8 +39,12 @@
 #include <ppd/ppd.h>
 #include <ppd/ppd-filter.h>
 #include <ppd/libcups2-private.h>
+#ifdef HAVE_MEMFD_CREATE
+#  include <sys/mman.h>
+#endif // HAVE_MEMFD_CREATE
 
 #define MAX_CHECK_COMMENT_LINES	20
+#define PREFIX_SIZE		65536	// Bytes of input to examine in memory
 
 //
 // Type definitions
@@ -104,45 +110,65 @@ const char *pstops_exclude_page_management[] =
   NULL
 };
 
+//
+// Get the next line out of the in-memory beginning of the input file,
+// like fgets()
+//
+
+static char *				// O - Line or NULL at end of data
+prefix_gets(char *buf,			// I - Line buffer
+	    int bufsize,		// I - Size of line buffer
+	    const char *prefix,		// I - Beginning of input file
+	    size_t prefix_len,		// I - Length of prefix
+	    size_t *pos)		// IO - Position in prefix
+{
+  char	*ptr = buf,			// Pointer into line buffer
+	*end = buf + bufsize - 1;	// End of line buffer
+
+
+  if (*pos >= prefix_len)
+    return (NULL);
+
+  while (*pos < prefix_len && ptr < end)
+    if ((*ptr++ = prefix[(*pos) ++]) == '\n')
+      break;
+  *ptr = '\0';
+
+  return (buf);
+}
+
+
 //
 // Check whether we were called after the "pdftopdf" filter and extract
 // parameters passed over by "pdftopdf" in the header comments of the PDF
-// file
+// file, we only look into the beginning of the file which we have already
+// read into memory
 //
 
 static void
-parse_pdftopdf_comment(char *filename,		// I - Input file
+parse_pdftopdf_comment(const char *prefix,	// I - Beginning of input
+						//     file
+		       size_t prefix_len,	// I - Length of prefix
 		       int *pdftopdfapplied,	// O - Does the input
 						//     data come from
 						//     pdftopdf filter?
 		       char *deviceCopies,	// O - Number of copies
 						//     (hardware)
-		       int *deviceCollate,	// O - Hardware collate
-		       cf_logfunc_t log,	// I - Log function
-		       void *ld)		// I - Aux. data for
-						//     log function
+		       int *deviceCollate)	// O - Hardware collate
 {
   char buf[4096];
   int i;
-  FILE *fp;
-
-  if ((fp = fopen(filename, "rb")) == NULL)
-  {
-    if (log) log(ld, CF_LOGLEVEL_ERROR,
-		 "ppdFilterPDFToPS: Cannot open input file \"%s\"",
-		 filename);
-    return;
-  }
+  size_t pos = 0;
 
   // skip until PDF start header
-  while (fgets(buf, sizeof(buf), fp) != 0)
+  while (prefix_gets(buf, sizeof(buf), prefix, prefix_len, &pos) != 0)
   {
     if (strncmp(buf, "%PDF", 4) == 0)
       break;
   }
   for (i = 0; i < MAX_CHECK_COMMENT_LINES; i ++)
   {
-    if (fgets(buf, sizeof(buf), fp) == 0)
+    if (prefix_gets(buf, sizeof(buf), prefix, prefix_len, &pos) == 0)
       break;
     if (strncmp(buf, "%%PDFTOPDFNumCopies", 19) == 0)
     {
@@ -175,8 +201,6 @@ parse_pdftopdf_comment(char *filename,		// I - Input file
     else if (strcmp(buf, "% This file was generated by pdftopdf") == 0)
       *pdftopdfapplied = 1;
   }
-
-  fclose(fp);
 }
 
 
@@ -186,30 +210,18 @@ parse_pdftopdf_comment(char *filename,		// I - Input file
 
 static int                     // O - Result: 1: Empty; 0: Contains pages
 is_empty(char *filename,       // I - Input file
+	 size_t prefix_len,    // I - Bytes in the beginning of the file
 	 cf_logfunc_t log,     // I - Log function
 	 void *ld)             // I - Auxiliary data for log function
 {
-  FILE *fp = NULL;
-  fp = fopen(filename, "rb");
-  if (fp == NULL)
+  if (prefix_len == 0)
   {
-    if (log) log(ld, CF_LOGLEVEL_ERROR,
-		 "ppdFilterPDFToPS: Cannot open input file \"%s\"",
-		 filename);
+    if (log) log(ld, CF_LOGLEVEL_DEBUG,
+		 "ppdFilterPDFToPS: Input is empty, outputting empty file.");
     return (1);
   }
   else
   {
-    char buf[1];
-    rewind(fp);
-    if (fread(buf, 1, 1, fp) == 0)
-    {
-      fclose(fp);
-      if (log) log(ld, CF_LOGLEVEL_DEBUG,
-		   "ppdFilterPDFToPS: Input is empty, outputting empty file.");
-      return (1);
-    }
-    fclose(fp);
     int pages = cfPDFPages(filename);
     if (pages == 0)
     {
@@ -292,7 +304,11 @@ ppdFilterPDFToPS(int inputfd,		// I - File descriptor input stream
   int		deviceCollate = 0;      // Hardware collate
   char          make_model[128] = "";   // Printer make and model (for quirks)
   char		*filename,		// PDF file to convert
-		tempfile[1024];		// Temporary file
+		tempfile[1024],		// Temporary file
+		memfile[32],		// Path of memory file
+		*prefix;		// Beginning of the input file
+  size_t	prefix_len = 0;		// Bytes in prefix
+  int		memfd = -1;		// Memory file
   char		buffer[8192];		// Copy buffer
   int		bytes;			// Bytes copied
   int		num_options = 0,	// Number of options
@@ -367,21 +383,66 @@ ppdFilterPDFToPS(int inputfd,		// I - File descriptor input stream
   }
 
   //
-  // Copy input into temporary file ...
+  // Read the beginning of the input into memory, to check whether it is
+  // empty and whether it comes from pdftopdf without reopening files
   //
 
-  if ((fd = cupsCreateTempFd(NULL, NULL, tempfile, sizeof(tempfile))) < 0)
+  if ((prefix = malloc(PREFIX_SIZE)) == NULL)
   {
     if (log) log(ld, CF_LOGLEVEL_ERROR,
-		 "ppdFilterPDFToPS: Unable to copy PDF file: %s", strerror(errno));
+		 "ppdFilterPDFToPS: Unable to allocate memory: %s",
+		 strerror(errno));
 
     fclose(inputfp);
     return (1);
   }
 
-  if (log) log(ld, CF_LOGLEVEL_DEBUG,
-	       "ppdFilterPDFToPS: Copying input to temp file \"%s\"",
-	       tempfile);
+  while (prefix_len < PREFIX_SIZE &&
+	 (bytes = fread(prefix + prefix_len, 1, PREFIX_SIZE - prefix_len,
+			inputfp)) > 0)
+    prefix_len += bytes;
+
+  //
+  // Copy input into an anonymous memory file, so that we do not need to
+  // write it to disk, or into a temporary file ...
+  //
+
+  tempfile[0] = '\0';
+
+#ifdef HAVE_MEMFD_CREATE
+  if ((memfd = memfd_create("ppdFilterPDFToPS", MFD_CLOEXEC)) >= 0)
+  {
+    snprintf(memfile, sizeof(memfile), "/dev/fd/%d", memfd);
+    filename = memfile;
+    fd = memfd;
+
+    if (log) log(ld, CF_LOGLEVEL_DEBUG,
+		 "ppdFilterPDFToPS: Copying input to memory file \"%s\"",
+		 memfile);
+  }
+  else
+#endif // HAVE_MEMFD_CREATE
+  {
+    if ((fd = cupsCreateTempFd(NULL, NULL, tempfile, sizeof(tempfile))) < 0)
+    {
+      if (log) log(ld, CF_LOGLEVEL_ERROR,
+		   "ppdFilterPDFToPS: Unable to copy PDF file: %s",
+		   strerror(errno));
+
+      free(prefix);
+      fclose(inputfp);
+      return (1);
+    }
+
+    filename = tempfile;
+
+    if (log) log(ld, CF_LOGLEVEL_DEBUG,
+		 "ppdFilterPDFToPS: Copying input to temp file \"%s\"",
+		 tempfile);
+  }
+
+  if (prefix_len > 0)
+    bytes = write(fd, prefix, prefix_len);
 
   while ((bytes = fread(buffer, 1, sizeof(buffer), inputfp)) > 0)
     bytes = write(fd, buffer, bytes);
@@ -391,18 +452,27 @@ ppdFilterPDFToPS(int inputfd,		// I - File descriptor input stream
     fclose(inputfp);
     close(inputfd);
   }
-  close(fd);
 
-  filename = tempfile;
+  //
+  // The memory file is gone when we close it, so keep it open for the
+  // renderer to read it via /dev/fd/...
+  //
+
+  if (fd != memfd)
+    close(fd);
 
   //
   // Stop on empty or zero-pages files without error, perhaps we eliminated
   // all pages via the "page-ranges" option and a previous filter
   //
 
-  if (is_empty(filename, log, ld))
+  if (is_empty(filename, prefix_len, log, ld))
   {
-    unlink(tempfile);
+    free(prefix);
+    if (memfd >= 0)
+      close(memfd);
+    if (tempfile[0])
+      unlink(tempfile);
     return 0;
   }
 
@@ -410,8 +480,10 @@ ppdFilterPDFToPS(int inputfd,		// I - File descriptor input stream
   // Read out copy counts and collate setting passed over by pdftopdf
   //
 
-  parse_pdftopdf_comment(filename, &pdftopdfapplied, deviceCopies,
-			 &deviceCollate, log, ld);
+  parse_pdftopdf_comment(prefix, prefix_len, &pdftopdfapplied, deviceCopies,
+			 &deviceCollate);
+
+  free(prefix);
 
   //
   // CUPS option list
@@ -1241,6 +1313,14 @@ ppdFilterPDFToPS(int inputfd,		// I - File descriptor input stream
     else
       dup2(outputfd, 1);
 
+    //
+    // The renderer reads the input through /dev/fd, so only it gets the
+    // memory file...
+    //
+
+    if (memfd >= 0)
+      fcntl(memfd, F_SETFD, 0);
+
     if (renderer == PDFTOPS)
     {
       execvp(CUPS_POPPLER_PDFTOPS, pdf_argv);
@@ -1864,7 +1944,11 @@ ppdFilterPDFToPS(int inputfd,		// I - File descriptor input stream
 
   close(outputfd);
 
-  unlink(tempfile);
+  if (memfd >= 0)
+    close(memfd);
+
+  if (tempfile[0])
+    unlink(tempfile);
 
   return (exit_status);
 }
@@ -28,11 +28,46 @@
 #include <string.h>
 
 
+//
+// Local types...
+//
+
+typedef struct _ppd_custom_order_s	// **** Custom choice order ****
+{
+  char		keyword[PPD_MAX_NAME];	// Option keyword
+  ppd_section_t	section;		// Section to emit in
+  float		order;			// OrderDependency value
+} _ppd_custom_order_t;
+
+typedef struct _ppd_emit_entry_s	// **** Option in emit order ****
+{
+  ppd_option_t	*option;		// Option
+  ppd_section_t	section;		// Section to emit in
+  float		order;			// OrderDependency value
+  int		custom,			// Entry for the Custom choice?
+		has_custom;		// Does the Custom choice have its own
+					// entry?
+} _ppd_emit_entry_t;
+
+struct _ppd_emit_plan_s			// **** Options in emit order ****
+{
+  int			num_entries;	// Number of entries
+  _ppd_emit_entry_t	*entries;	// Entries sorted by section, order,
+					// and keyword
+};
+
+
 //
 // Local functions...
 //
 
 static int	ppd_compare_cparams(ppd_cparam_t *a, ppd_cparam_t *b);
+static int	ppd_compare_custom_orders(_ppd_custom_order_t *a,
+		                          _ppd_custom_order_t *b);
+static int	ppd_compare_emit_entries(_ppd_emit_entry_t *a,
+		                         _ppd_emit_entry_t *b);
+static void	ppd_create_emit_plan(ppd_file_t *ppd);
+static cups_array_t *ppd_load_custom_orders(ppd_file_t *ppd);
 
 
 //
@@ -77,12 +112,15 @@ ppdCollect2(ppd_file_t    *ppd,		// I - PPD file data
 	    float         min_order,	// I - Minimum OrderDependency value
             ppd_choice_t  ***choices)	// O - Pointers to choices
 {
-  ppd_choice_t	*c;			// Current choice
-  ppd_section_t	csection;		// Current section
-  float		corder;			// Current OrderDependency value
-  int		count;			// Number of choices collected
+  ppd_choice_t	*c,			// Current choice
+		key;			// Search key for marked choices
+  int		count,			// Number of choices collected
+		max_count,		// Maximum number of choices
+		custom,			// Is this the Custom choice?
+		lo, hi, mid;		// Bounds of binary search
   ppd_choice_t	**collect;		// Collected choices
-  float		*orders;		// Collected order values
+  _ppd_emit_entry_t *e,			// Current emit plan entry
+		*end;			// End of emit plan
 
 
   DEBUG_printf(("ppdCollect2(ppd=%p, section=%d, min_order=%f, choices=%p)",
@@ -96,109 +134,80 @@ ppdCollect2(ppd_file_t    *ppd,		// I - PPD file data
     return (0);
   }
 
+  //
+  // The options are sorted by section and OrderDependency value once per
+  // PPD file...
+  //
+
+  if (!ppd->emit_plan)
+    ppd_create_emit_plan(ppd);
+
   //
   // Allocate memory for up to N selected choices...
   //
 
-  count = 0;
-  if ((collect = calloc(sizeof(ppd_choice_t *),
-                        (size_t)cupsArrayGetCount(ppd->marked))) == NULL)
+  count     = 0;
+  max_count = cupsArrayGetCount(ppd->marked);
+
+  if (!ppd->emit_plan || max_count == 0 ||
+      (collect = calloc(sizeof(ppd_choice_t *), (size_t)max_count)) == NULL)
   {
     *choices = NULL;
     return (0);
   }
 
-  if ((orders = calloc(sizeof(float),
-		       (size_t)cupsArrayGetCount(ppd->marked))) == NULL)
+  //
+  // Find the first option of the section with at least the minimum order...
+  //
+
+  lo = 0;
+  hi = ppd->emit_plan->num_entries;
+
+  while (lo < hi)
   {
-    *choices = NULL;
-    free(collect);
-    return (0);
+    mid = (lo + hi) / 2;
+    e   = ppd->emit_plan->entries + mid;
+
+    if (e->section < section ||
+        (e->section == section && e->order < min_order))
+      lo = mid + 1;
+    else
+      hi = mid;
   }
 
   //
-  // Loop through all options and add choices as needed...
+  // Then collect the marked choices of the options in plan order...
   //
 
-  for (c = (ppd_choice_t *)cupsArrayGetFirst(ppd->marked);
-       c;
-       c = (ppd_choice_t *)cupsArrayGetNext(ppd->marked))
+  for (e = ppd->emit_plan->entries + lo,
+           end = ppd->emit_plan->entries + ppd->emit_plan->num_entries;
+       e < end && e->section == section;
+       e ++)
   {
-    csection = c->option->section;
-    corder   = c->option->order;
+    key.option = e->option;
 
-    if (!strcmp(c->choice, "Custom"))
+    for (c = (ppd_choice_t *)cupsArrayFind(ppd->marked, &key);
+         c && !strcmp(c->option->keyword, e->option->keyword) &&
+	     count < max_count;
+	 c = (ppd_choice_t *)cupsArrayGetNext(ppd->marked))
     {
-      ppd_attr_t	*attr;		// NonUIOrderDependency value
-      float		aorder;		// Order value
-      char		asection[17],	// Section name
-			amain[PPD_MAX_NAME + 1],
-			aoption[PPD_MAX_NAME];
-					// *CustomFoo and True
+      if (c->option != e->option)
+        continue;
 
+      //
+      // A Custom choice with a NonUIOrderDependency of its own is emitted
+      // at that position instead of the option's...
+      //
 
-      for (attr = ppdFindAttr(ppd, "NonUIOrderDependency", NULL);
-           attr;
-	   attr = ppdFindNextAttr(ppd, "NonUIOrderDependency", NULL))
-        if (attr->value &&
-	    sscanf(attr->value, "%f%16s%41s%40s", &aorder, asection, amain,
-	           aoption) == 4 &&
-	    !strncmp(amain, "*Custom", 7) &&
-	    !strcmp(amain + 7, c->option->keyword) && !strcmp(aoption, "True"))
-	{
-	  //
-	  // Use this NonUIOrderDependency...
-	  //
+      custom = !strcmp(c->choice, "Custom");
 
-          corder = aorder;
-
-	  if (!strcmp(asection, "DocumentSetup"))
-	    csection = PPD_ORDER_DOCUMENT;
-	  else if (!strcmp(asection, "ExitServer"))
-	    csection = PPD_ORDER_EXIT;
-	  else if (!strcmp(asection, "JCLSetup"))
-	    csection = PPD_ORDER_JCL;
-	  else if (!strcmp(asection, "PageSetup"))
-	    csection = PPD_ORDER_PAGE;
-	  else if (!strcmp(asection, "Prolog"))
-	    csection = PPD_ORDER_PROLOG;
-	  else
-	    csection = PPD_ORDER_ANY;
-	  break;
-	}
-    }
+      if (e->custom ? !custom : (custom && e->has_custom))
+        continue;
 
-    if (csection == section && corder >= min_order)
-    {
-      collect[count] = c;
-      orders[count]  = corder;
-      count ++;
+      collect[count ++] = c;
     }
   }
 
-  //
-  // If we have more than 1 marked choice, sort them...
-  //
-
-  if (count > 1)
-  {
-    int i, j;				// Looping vars
-
-    for (i = 0; i < (count - 1); i ++)
-      for (j = i + 1; j < count; j ++)
-        if (orders[i] > orders[j])
-	{
-	  c          = collect[i];
-	  corder     = orders[i];
-	  collect[i] = collect[j];
-	  orders[i]  = orders[j];
-	  collect[j] = c;
-	  orders[j]  = corder;
-	}
-  }
-
-  free(orders);
-
   DEBUG_printf(("2ppdCollect2: %d marked choices...", count));
 
   //
@@ -1290,3 +1299,215 @@ ppd_compare_cparams(ppd_cparam_t *a,	// I - First parameter
 {
   return (a->order - b->order);
 }
+
+
+//
+// 'ppd_compare_custom_orders()' - Compare the keywords of two custom choice
+//                                 orders.
+//
+
+static int				// O - Result of comparison
+ppd_compare_custom_orders(
+    _ppd_custom_order_t *a,		// I - First custom order
+    _ppd_custom_order_t *b)		// I - Second custom order
+{
+  return (strcmp(a->keyword, b->keyword));
+}
+
+
+//
+// 'ppd_compare_emit_entries()' - Compare the emit order of two options.
+//
+// Options with the same OrderDependency value are sorted by keyword, the
+// order in which they are found in the array of marked choices.
+//
+
+static int				// O - Result of comparison
+ppd_compare_emit_entries(
+    _ppd_emit_entry_t *a,		// I - First entry
+    _ppd_emit_entry_t *b)		// I - Second entry
+{
+  int	result;				// Result of comparison
+
+
+  if (a->section != b->section)
+    return (a->section < b->section ? -1 : 1);
+  else if (a->order != b->order)
+    return (a->order < b->order ? -1 : 1);
+  else if ((result = strcmp(a->option->keyword, b->option->keyword)) != 0)
+    return (result);
+  else
+    return (a->custom - b->custom);
+}
+
+
+//
+// 'ppd_create_emit_plan()' - Sort the options of a PPD file by section and
+//                            OrderDependency value.
+//
+// The plan does not depend on the marked choices, so ppdCollect2() just
+// picks the marked choices out of it instead of sorting them on every call.
+//
+
+static void
+ppd_create_emit_plan(ppd_file_t *ppd)	// I - PPD file
+{
+  int			i, j, k;	// Looping vars
+  int			num_entries;	// Number of entries
+  ppd_group_t		*g,		// Current group
+			*sg,		// Current subgroup
+			*cg;		// Group or subgroup with options
+  ppd_option_t		*o;		// Current option
+  cups_array_t		*corders;	// NonUIOrderDependency values of
+					// custom choices
+  _ppd_custom_order_t	key,		// Search key
+			*match;		// Matching custom order
+  struct _ppd_emit_plan_s *plan;	// Emit plan
+  _ppd_emit_entry_t	*e;		// Current entry
+
+
+  if ((corders = ppd_load_custom_orders(ppd)) == NULL)
+    return;
+
+  //
+  // Each option gets one entry, plus one for its Custom choice if that has
+  // its own NonUIOrderDependency...
+  //
+
+  for (i = ppd->num_groups, g = ppd->groups, num_entries = 0;
+       i > 0;
+       i --, g ++)
+  {
+    num_entries += g->num_options;
+
+    for (j = g->num_subgroups, sg = g->subgroups; j > 0; j --, sg ++)
+      num_entries += sg->num_options;
+  }
+
+  num_entries += cupsArrayGetCount(corders);
+
+  if ((plan = malloc(sizeof(struct _ppd_emit_plan_s) +
+                     (size_t)num_entries * sizeof(_ppd_emit_entry_t))) == NULL)
+  {
+    cupsArrayDelete(corders);
+    return;
+  }
+
+  plan->entries     = (_ppd_emit_entry_t *)(plan + 1);
+  plan->num_entries = 0;
+
+  for (i = ppd->num_groups, g = ppd->groups; i > 0; i --, g ++)
+  {
+    for (j = -1; j < g->num_subgroups; j ++)
+    {
+      cg = j < 0 ? g : g->subgroups + j;
+
+      for (k = cg->num_options, o = cg->options; k > 0; k --, o ++)
+      {
+	e          = plan->entries + plan->num_entries ++;
+	e->option  = o;
+	e->section = o->section;
+	e->order   = o->order;
+	e->custom  = 0;
+
+	strlcpy(key.keyword, o->keyword, sizeof(key.keyword));
+
+	if ((match = (_ppd_custom_order_t *)cupsArrayFind(corders,
+	                                                  &key)) != NULL &&
+	    plan->num_entries < num_entries)
+	{
+	  e->has_custom = 1;
+
+	  e             = plan->entries + plan->num_entries ++;
+	  e->option     = o;
+	  e->section    = match->section;
+	  e->order      = match->order;
+	  e->custom     = 1;
+	  e->has_custom = 1;
+	}
+	else
+	  e->has_custom = 0;
+      }
+    }
+  }
+
+  cupsArrayDelete(corders);
+
+  qsort(plan->entries, (size_t)plan->num_entries, sizeof(_ppd_emit_entry_t),
+        (int (*)(const void *, const void *))ppd_compare_emit_entries);
+
+  ppd->emit_plan = plan;
+}
+
+
+//
+// 'ppd_load_custom_orders()' - Load the NonUIOrderDependency values of the
+//                              custom choices.
+//
+// The "*NonUIOrderDependency: order section *CustomFoo True" attributes
+// are only parsed once per PPD file, when the emit plan is created.
+//
+
+static cups_array_t *			// O - Custom orders sorted by keyword
+ppd_load_custom_orders(ppd_file_t *ppd)	// I - PPD file
+{
+  cups_array_t		*corders;	// Custom orders
+  ppd_attr_t		*attr;		// NonUIOrderDependency value
+  _ppd_custom_order_t	*corder;	// Custom order
+  float			aorder;		// Order value
+  char			asection[17],	// Section name
+			amain[PPD_MAX_NAME + 1],
+			aoption[PPD_MAX_NAME];
+					// *CustomFoo and True
+
+
+  if ((corders =
+           cupsArrayNew((cups_array_cb_t)ppd_compare_custom_orders, NULL,
+                        NULL, 0, NULL, (cups_afree_cb_t)free)) == NULL)
+    return (NULL);
+
+  for (attr = ppdFindAttr(ppd, "NonUIOrderDependency", NULL);
+       attr;
+       attr = ppdFindNextAttr(ppd, "NonUIOrderDependency", NULL))
+  {
+    if (!attr->value ||
+        sscanf(attr->value, "%f%16s%41s%40s", &aorder, asection, amain,
+	       aoption) != 4 ||
+	strncmp(amain, "*Custom", 7) || !amain[7] || strcmp(aoption, "True"))
+      continue;
+
+    if ((corder = calloc(1, sizeof(_ppd_custom_order_t))) == NULL)
+      break;
+
+    strlcpy(corder->keyword, amain + 7, sizeof(corder->keyword));
+
+    if (cupsArrayFind(corders, corder))
+    {
+      //
+      // The first NonUIOrderDependency for an option wins...
+      //
+
+      free(corder);
+      continue;
+    }
+
+    corder->order = aorder;
+
+    if (!strcmp(asection, "DocumentSetup"))
+      corder->section = PPD_ORDER_DOCUMENT;
+    else if (!strcmp(asection, "ExitServer"))
+      corder->section = PPD_ORDER_EXIT;
+    else if (!strcmp(asection, "JCLSetup"))
+      corder->section = PPD_ORDER_JCL;
+    else if (!strcmp(asection, "PageSetup"))
+      corder->section = PPD_ORDER_PAGE;
+    else if (!strcmp(asection, "Prolog"))
+      corder->section = PPD_ORDER_PROLOG;
+    else
+      corder->section = PPD_ORDER_ANY;
+
+    cupsArrayAdd(corders, corder);
+  }
+
+  return (corders);
+}
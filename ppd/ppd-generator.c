@@ -27,6 +27,8 @@
 #include <ppd/ppd.h>
 #include <ppd/string-private.h>
 #include <ppd/libcups2-private.h>
+#include <ppd/ipp-private.h>
+#include <ppd/thread-private.h>
 #include <cupsfilters/ipp.h>
 #include <cupsfilters/catalog.h>
 #include <limits.h>
@@ -45,6 +47,13 @@
 #endif
 
 
+//
+// Constants...
+//
+
+#define PPD_MAX_GENERATED 16		// Number of generated PPDs to remember
+
+
 //
 // Types...
 //
@@ -65,6 +74,30 @@ typedef struct _ppd_size_s                // **** Media Size (cups_size_t of lib
                                         // millimeters
 } _ppd_size_t;
 
+typedef struct _ppd_generated_s		// **** Generated PPD file ****
+{
+  unsigned long long hash;		// Hash of the generator input
+  size_t	ipp_length;		// Length of the hashed IPP values
+  unsigned	last_used;		// Use counter value of last use
+  char		*data;			// PPD file contents
+  size_t	datalen;		// Length of PPD file contents
+  char		status_msg[256];	// Status message
+} _ppd_generated_t;
+
+
+//
+// Local globals...
+//
+
+static _ppd_mutex_t	generated_mutex = _PPD_MUTEX_INITIALIZER;
+					// Mutex to control access to cache
+static _ppd_generated_t	generated[PPD_MAX_GENERATED];
+					// Recently generated PPD files
+static unsigned		generated_used = 0;
+					// Use counter
+static unsigned		generated_hits = 0;
+					// Number of PPD files copied from cache
+
 
 //
 // Local functions...
@@ -72,6 +105,41 @@ typedef struct _ppd_size_s                // **** Media Size (cups_size_t of lib
 
 static int	http_connect(http_t **http, const char *url, char *resource,
 			     size_t ressize);
+static char	*ppd_create_ppd_from_ipp(char *buffer, size_t bufsize,
+					 ipp_t *supported,
+					 const char *make_model,
+					 const char *pdl, int color,
+					 int duplex, cups_array_t *conflicts,
+					 cups_array_t *sizes,
+					 char *default_pagesize,
+					 const char *default_cluster_color,
+					 char *status_msg,
+					 size_t status_msg_size,
+					 cups_array_t *opt_strings);
+static char	*ppd_create_ppd_from_ipp2(char *buffer, size_t bufsize,
+					  ipp_t *supported,
+					  const char *make_model,
+					  const char *pdl, int color,
+					  int duplex,
+					  cups_array_t *conflicts,
+					  cups_array_t *sizes,
+					  char *default_pagesize,
+					  const char *default_cluster_color,
+					  char *status_msg,
+					  size_t status_msg_size,
+					  cups_array_t *opt_strings);
+static void	ppd_generated_add(unsigned long long hash, size_t ipp_length,
+				  const char *filename,
+				  const char *status_msg);
+static char	*ppd_generated_copy(unsigned long long hash,
+				    size_t ipp_length, char *buffer,
+				    size_t bufsize, char *status_msg,
+				    size_t status_msg_size);
+static unsigned long long ppd_hash_ipp(unsigned long long hash,
+				       ipp_t *ipp, int all,
+				       size_t *length);
+static unsigned long long ppd_hash_string(unsigned long long hash,
+					  const char *s);
 static void	ppd_put_string(cups_file_t *fp, cups_lang_t *lang, const char *ppd_option, const char *ppd_choice, const char *pwg_msgid);
 
 
@@ -139,6 +207,25 @@ char ppdgenerator_msg[1024];
 //
 
 
+//
+// '_ppdGeneratedHits()' - Return how many PPD files were copied from the
+//                         recently generated ones.
+//
+
+unsigned				// O - Number of copied PPD files
+_ppdGeneratedHits(void)
+{
+  unsigned	hits;			// Number of copied PPD files
+
+
+  _ppdMutexLock(&generated_mutex);
+  hits = generated_hits;
+  _ppdMutexUnlock(&generated_mutex);
+
+  return (hits);
+}
+
+
 //
 // 'ppdCreatePPDFromIPP()' - Create a PPD file describing the capabilities
 //                           of an IPP printer, using info from DNS-SD record
@@ -178,6 +265,14 @@ ppdCreatePPDFromIPP(char         *buffer,          // I - Filename buffer
 //                            extra parameters for PPDs from a merged
 //                            IPP record for printer clusters
 //
+// The contents of the recently generated PPD files are remembered,
+// keyed by a hash of the IPP attributes the generator reads and the
+// other parameters, so that a printer whose capabilities have not
+// changed since the last time gets a copy of its previous PPD file
+// without generating it again.  Volatile attributes like
+// "printer-state" or "printer-up-time" and the request ID are not part
+// of the hash.
+//
 
 char *                                              // O - PPD filename or NULL
 						    //     on error
@@ -208,6 +303,113 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 						    //     ignore message
 		     size_t       status_msg_size)  // I - Size of status
 						    //     message buffer
+{
+  return (ppd_create_ppd_from_ipp2(buffer, bufsize, supported, make_model,
+				   pdl, color, duplex, conflicts, sizes,
+				   default_pagesize, default_cluster_color,
+				   status_msg, status_msg_size, NULL));
+}
+
+
+//
+// 'ppdCreatePPDsFromIPP()' - Create PPD files for several IPP printers.
+//
+// This generates a PPD file for each of the "num_printers" Get-Printer-
+// Attributes responses, like ppdCreatePPDFromIPP() does, and is meant for
+// setting up many printers at once.  The standard UI strings catalog is
+// only loaded once for all of them and printers with identical
+// capabilities get copies of the same PPD file.
+//
+// "make_models", "pdls", "colors", and "duplexes" hold the DNS-SD values
+// for each printer and may be `NULL` if not known.  The name of each
+// PPD file is stored in "buffers", an empty string marks a printer for
+// which no PPD file could be created.  If "status_msgs" is not `NULL`,
+// the status message of each printer is stored in it.
+//
+
+int					// O - Number of PPD files created
+ppdCreatePPDsFromIPP(
+    int          num_printers,		// I - Number of printers
+    ipp_t        **supported,		// I - Get-Printer-Attributes responses
+    const char   **make_models,		// I - Makes and models from DNS-SD
+    const char   **pdls,		// I - Lists of PDLs from DNS-SD
+    const int    *colors,		// I - Color printers? (from DNS-SD)
+    const int    *duplexes,		// I - Duplex printers? (from DNS-SD)
+    char         **buffers,		// I - Filename buffers
+    size_t       bufsize,		// I - Size of each filename buffer
+    char         **status_msgs,		// I - Status message buffers or
+					//     `NULL`
+    size_t       status_msg_size)	// I - Size of each status message
+					//     buffer
+{
+  int		i,			// Looping var
+		count = 0;		// Number of PPD files created
+  cups_array_t	*opt_strings;		// Standard option UI strings
+
+
+  if (num_printers <= 0 || !supported || !buffers)
+    return (0);
+
+  opt_strings = cfCatalogOptionArrayNew();
+  cfCatalogLoad(NULL, NULL, opt_strings);
+
+  for (i = 0; i < num_printers; i ++)
+  {
+    if (ppd_create_ppd_from_ipp2(buffers[i], bufsize, supported[i],
+				 make_models ? make_models[i] : NULL,
+				 pdls ? pdls[i] : NULL,
+				 colors ? colors[i] : 0,
+				 duplexes ? duplexes[i] : 0,
+				 NULL, NULL, NULL, NULL,
+				 status_msgs ? status_msgs[i] : NULL,
+				 status_msg_size, opt_strings))
+      count ++;
+  }
+
+  cupsArrayDelete(opt_strings);
+
+  return (count);
+}
+
+
+//
+// 'ppd_create_ppd_from_ipp()' - Generate a PPD file for
+//                               ppdCreatePPDFromIPP2() and
+//                               ppdCreatePPDsFromIPP().
+//
+
+static char *                                       // O - PPD filename or NULL
+						    //     on error
+ppd_create_ppd_from_ipp(char         *buffer,    // I - Filename buffer
+			size_t       bufsize,       // I - Size of filename
+						    //     buffer
+			ipp_t        *supported,    // I - Get-Printer-
+						    //     Attributes response
+			const char   *make_model,   // I - Make and model from
+						    //     DNS-SD
+			const char   *pdl,          // I - List of PDLs from
+						    //     DNS-SD
+			int          color,         // I - Color printer? (from
+						    //     DNS-SD)
+			int          duplex,        // I - Duplex printer? (from
+						    //     DNS-SD)
+			cups_array_t *conflicts,    // I - Array of
+						    //     constraints
+			cups_array_t *sizes,        // I - Media sizes we've
+						    //     added
+			char*        default_pagesize, // I - Default page size
+			const char   *default_cluster_color, // I - cluster def
+						    //     color (if cluster's
+						    //     attributes are
+						    //     returned)
+			char         *status_msg,   // I - Status message
+						    //     buffer, NULL to
+						    //     ignore message
+			size_t       status_msg_size, // I - Size of status
+						    //     message buffer
+			cups_array_t *opt_strings)  // I - Standard option
+						    //     UI strings or NULL
+						    //     to load them
 {
   cups_lang_t		*lang;		// Localization language
   cups_file_t		*fp;		// PPD file
@@ -274,6 +476,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 			firsttolast = 1;
   int			manual_copies = -1,
 			is_fax = 0;
+  _ppd_ipp_index_t	*attr_index;	// Hashed view of the attributes
 
   //
   // Range check input...
@@ -296,6 +499,17 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     return (NULL);
   }
 
+  //
+  // Index the attributes, we look up lots of them...
+  //
+
+  if ((attr_index = _ppdIppIndexNew(supported)) == NULL)
+  {
+    if (status_msg && status_msg_size)
+      snprintf(status_msg, status_msg_size, "%s", strerror(ENOMEM));
+    return (NULL);
+  }
+
   //
   // Open a temporary file for the PPD...
   //
@@ -304,6 +518,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   {
     if (status_msg && status_msg_size)
       snprintf(status_msg, status_msg_size, "%s", strerror(errno));
+    _ppdIppIndexDelete(attr_index);
     return (NULL);
   }
 
@@ -311,7 +526,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // Get a sanitized make and model...
   //
 
-  if ((attr = ippFindAttribute(supported, "printer-make-and-model", IPP_TAG_TEXT)) != NULL && ippValidateAttribute(attr))
+  if ((attr = _ppdIppIndexFind(attr_index, "printer-make-and-model", IPP_TAG_TEXT)) != NULL && ippValidateAttribute(attr))
   {
     // Sanitize the model name to only contain PPD-safe characters.
     strlcpy(make, ippGetString(attr, 0, NULL), sizeof(make));
@@ -383,11 +598,11 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   cupsFilePuts(fp, "*FileSystem: False\n");
   cupsFilePuts(fp, "*PCFileName: \"drvless.ppd\"\n");
 
-  if ((attr = ippFindAttribute(supported, "ipp-features-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "ipp-features-supported",
 			       IPP_TAG_KEYWORD)) != NULL &&
       ippContainsString(attr, "faxout"))
   {
-    attr = ippFindAttribute(supported, "printer-uri-supported",
+    attr = _ppdIppIndexFind(attr_index, "printer-uri-supported",
 			    IPP_TAG_URI);
     if (attr)
     {
@@ -405,13 +620,13 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   cupsFilePrintf(fp, "*ShortNickName: \"%s %s\"\n", make, model);
 
   // Which is the default output bin?
-  if ((attr = ippFindAttribute(supported, "output-bin-default", IPP_TAG_ZERO))
+  if ((attr = _ppdIppIndexFind(attr_index, "output-bin-default", IPP_TAG_ZERO))
       != NULL)
     defaultoutbin = strdup(ippGetString(attr, 0, NULL));
   // Find out on which position of the list of output bins the default one is,
   // if there is no default bin, take the first of this list
   i = 0;
-  if ((attr = ippFindAttribute(supported, "output-bin-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "output-bin-supported",
 			       IPP_TAG_ZERO)) != NULL)
   {
     count = ippGetCount(attr);
@@ -428,7 +643,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 	break;
     }
   }
-  if ((attr = ippFindAttribute(supported, "printer-output-tray",
+  if ((attr = _ppdIppIndexFind(attr_index, "printer-output-tray",
 			       IPP_TAG_STRING)) != NULL &&
       i < ippGetCount(attr))
   {
@@ -456,7 +671,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     cupsFilePuts(fp, "*DefaultOutputOrder: Normal\n");
 
   // Do we have a color printer?
-  if (((attr = ippFindAttribute(supported,
+  if (((attr = _ppdIppIndexFind(attr_index,
 			       "color-supported", IPP_TAG_BOOLEAN)) != NULL &&
        ippGetBoolean(attr, 0)) ||
       color)
@@ -464,7 +679,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   else
     cupsFilePuts(fp, "*ColorDevice: False\n");
 
-  if ((attr = ippFindAttribute(supported,
+  if ((attr = _ppdIppIndexFind(attr_index,
 			       "landscape-orientation-requested-preferred",
 			       IPP_TAG_ZERO)) != NULL)
   {
@@ -478,7 +693,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 		 CUPS_VERSION_MINOR);
   cupsFilePuts(fp, "*cupsSNMPSupplies: False\n");
   cupsFilePuts(fp, "*cupsLanguages: \"en");
-  if ((lang_supp = ippFindAttribute(supported,
+  if ((lang_supp = _ppdIppIndexFind(attr_index,
 				    "printer-strings-languages-supported",
 				    IPP_TAG_LANGUAGE)) != NULL)
   {
@@ -492,18 +707,21 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   }
   cupsFilePuts(fp, "\"\n");
 
-  if ((attr = ippFindAttribute(supported, "printer-more-info", IPP_TAG_URI)) != NULL && ippValidateAttribute(attr))
+  if ((attr = _ppdIppIndexFind(attr_index, "printer-more-info", IPP_TAG_URI)) != NULL && ippValidateAttribute(attr))
     cupsFilePrintf(fp, "*APSupplies: \"%s\"\n", ippGetString(attr, 0, NULL));
 
-  if ((attr = ippFindAttribute(supported, "printer-charge-info-uri", IPP_TAG_URI)) != NULL && ippValidateAttribute(attr))
+  if ((attr = _ppdIppIndexFind(attr_index, "printer-charge-info-uri", IPP_TAG_URI)) != NULL && ippValidateAttribute(attr))
     cupsFilePrintf(fp, "*cupsChargeInfoURI: \"%s\"\n", ippGetString(attr, 0, NULL));
 
   // Message catalogs for UI strings
   lang = cupsLangDefault();
-  opt_strings_catalog = cfCatalogOptionArrayNew();
-  cfCatalogLoad(NULL, NULL, opt_strings_catalog);
+  if ((opt_strings_catalog = opt_strings) == NULL)
+  {
+    opt_strings_catalog = cfCatalogOptionArrayNew();
+    cfCatalogLoad(NULL, NULL, opt_strings_catalog);
+  }
 
-  if ((attr = ippFindAttribute(supported, "printer-strings-uri",
+  if ((attr = _ppdIppIndexFind(attr_index, "printer-strings-uri",
 			       IPP_TAG_URI)) != NULL && ippValidateAttribute(attr))
   {
     printer_opt_strings_catalog = cfCatalogOptionArrayNew();
@@ -513,7 +731,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     {
       http_t		*http = NULL;	// Connection to printer
       const char	*printer_uri =
-	ippGetString(ippFindAttribute(supported, "printer-uri-supported",
+	ippGetString(_ppdIppIndexFind(attr_index, "printer-uri-supported",
 				      IPP_TAG_URI), 0, NULL);
 					// Printer URI
       char		resource[256];	// Resource path
@@ -574,19 +792,19 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // Accounting...
   //
 
-  if (ippGetBoolean(ippFindAttribute(supported, "job-account-id-supported",
+  if (ippGetBoolean(_ppdIppIndexFind(attr_index, "job-account-id-supported",
 				     IPP_TAG_BOOLEAN), 0))
     cupsFilePuts(fp, "*cupsJobAccountId: True\n");
 
-  if (ippGetBoolean(ippFindAttribute(supported,
+  if (ippGetBoolean(_ppdIppIndexFind(attr_index,
 				     "job-accounting-user-id-supported",
 				     IPP_TAG_BOOLEAN), 0))
     cupsFilePuts(fp, "*cupsJobAccountingUserId: True\n");
 
-  if ((attr = ippFindAttribute(supported, "printer-privacy-policy-uri", IPP_TAG_URI)) != NULL && ippValidateAttribute(attr))
+  if ((attr = _ppdIppIndexFind(attr_index, "printer-privacy-policy-uri", IPP_TAG_URI)) != NULL && ippValidateAttribute(attr))
     cupsFilePrintf(fp, "*cupsPrivacyURI: \"%s\"\n", ippGetString(attr, 0, NULL));
 
-  if ((attr = ippFindAttribute(supported, "printer-mandatory-job-attributes", IPP_TAG_KEYWORD)) != NULL && ippValidateAttribute(attr))
+  if ((attr = _ppdIppIndexFind(attr_index, "printer-mandatory-job-attributes", IPP_TAG_KEYWORD)) != NULL && ippValidateAttribute(attr))
   {
     char	prefix = '\"';		// Prefix for string
 
@@ -606,7 +824,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     cupsFilePuts(fp, "\"\n");
   }
 
-  if ((attr = ippFindAttribute(supported, "printer-requested-job-attributes", IPP_TAG_KEYWORD)) != NULL && ippValidateAttribute(attr))
+  if ((attr = _ppdIppIndexFind(attr_index, "printer-requested-job-attributes", IPP_TAG_KEYWORD)) != NULL && ippValidateAttribute(attr))
   {
     char	prefix = '\"';		// Prefix for string
 
@@ -630,14 +848,14 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // Password/PIN printing...
   //
 
-  if ((attr = ippFindAttribute(supported, "job-password-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "job-password-supported",
 			       IPP_TAG_INTEGER)) != NULL)
   {
     char	pattern[33];		// Password pattern
     int		maxlen = ippGetInteger(attr, 0);
 					// Maximum length
     const char	*repertoire =
-      ippGetString(ippFindAttribute(supported,
+      ippGetString(_ppdIppIndexFind(attr_index,
 				    "job-password-repertoire-configured",
 				    IPP_TAG_KEYWORD), 0, NULL);
 					// Type of password
@@ -693,7 +911,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     goto bad_ppd;
   int formatfound = 0;
 
-  if (((attr = ippFindAttribute(supported, "document-format-supported",
+  if (((attr = _ppdIppIndexFind(attr_index, "document-format-supported",
 				IPP_TAG_MIMETYPE)) != NULL) ||
       (pdl && pdl[0] != '\0'))
   {
@@ -773,12 +991,12 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   }
 #ifdef CUPS_RASTER_HAVE_APPLERASTER
   else if (cupsArrayFind(pdl_list, "image/urf") &&
-	   (ippFindAttribute(supported, "urf-supported", IPP_TAG_KEYWORD) != NULL))
+	   (_ppdIppIndexFind(attr_index, "urf-supported", IPP_TAG_KEYWORD) != NULL))
   {
     int resStore = 0; // Variable for storing the no. of resolutions in the resolution array
     int resArray[__INT16_MAX__]; // Creating a resolution array supporting a maximum of 32767 resolutions.
     int lowdpi = 0, middpi = 0, hidpi = 0; // Lower , middle and higher resolution
-    if ((attr = ippFindAttribute(supported, "urf-supported",
+    if ((attr = _ppdIppIndexFind(attr_index, "urf-supported",
 			IPP_TAG_KEYWORD)) != NULL)
     {
       for (int i = 0, count = ippGetCount(attr); i < count; i ++)
@@ -855,11 +1073,11 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 	  // resolution is in the list, use it. If not, use the
 	  // middpi, rounding down if the number of available
 	  // resolutions is even.
-          if ((attr = ippFindAttribute(supported,
+          if ((attr = _ppdIppIndexFind(attr_index,
 				       "printer-resolution-supported",
 				       IPP_TAG_RESOLUTION)) != NULL)
           {
-            if ((defattr = ippFindAttribute(supported,
+            if ((defattr = _ppdIppIndexFind(attr_index,
 					    "printer-resolution-default",
 					    IPP_TAG_RESOLUTION)) != NULL)
             {
@@ -893,8 +1111,8 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   }
 #endif
   else if (cupsArrayFind(pdl_list, "image/pwg-raster") &&
-	   ippFindAttribute(supported, "pwg-raster-document-type-supported", IPP_TAG_KEYWORD) != NULL &&
-	   (attr = ippFindAttribute(supported, "pwg-raster-document-resolution-supported", IPP_TAG_RESOLUTION)) != NULL)
+	   _ppdIppIndexFind(attr_index, "pwg-raster-document-type-supported", IPP_TAG_KEYWORD) != NULL &&
+	   (attr = _ppdIppIndexFind(attr_index, "pwg-raster-document-resolution-supported", IPP_TAG_RESOLUTION)) != NULL)
   {
     current_def = NULL;
     if ((current_res = cfIPPAttrToResolutionArray(attr)) != NULL &&
@@ -908,9 +1126,9 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     }
   }
   else if (cupsArrayFind(pdl_list, "application/PCLm") &&
-	   (attr = ippFindAttribute(supported, "pclm-source-resolution-supported", IPP_TAG_RESOLUTION)) != NULL)
+	   (attr = _ppdIppIndexFind(attr_index, "pclm-source-resolution-supported", IPP_TAG_RESOLUTION)) != NULL)
   {
-    if ((defattr = ippFindAttribute(supported,
+    if ((defattr = _ppdIppIndexFind(attr_index,
 				    "pclm-source-resolution-default",
 				    IPP_TAG_RESOLUTION)) != NULL)
       current_def = cfIPPResToResolution(defattr, 0);
@@ -969,10 +1187,10 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // Use "printer-resolution-supported" attribute
   if (common_res == NULL)
   {
-    if ((attr = ippFindAttribute(supported, "printer-resolution-supported",
+    if ((attr = _ppdIppIndexFind(attr_index, "printer-resolution-supported",
 				 IPP_TAG_RESOLUTION)) != NULL)
     {
-      if ((defattr = ippFindAttribute(supported, "printer-resolution-default",
+      if ((defattr = _ppdIppIndexFind(attr_index, "printer-resolution-default",
 				      IPP_TAG_RESOLUTION)) != NULL)
 	current_def = cfIPPResToResolution(defattr, 0);
       else
@@ -999,7 +1217,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // No default resolution determined yet
   if (common_def == NULL)
   {
-    if ((defattr = ippFindAttribute(supported, "printer-resolution-default",
+    if ((defattr = _ppdIppIndexFind(attr_index, "printer-resolution-default",
 				    IPP_TAG_RESOLUTION)) != NULL)
     {
       common_def = cfIPPResToResolution(defattr, 0);
@@ -1379,7 +1597,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   else
     ppdname[0] = '\0';
 
-  if ((attr = ippFindAttribute(supported, "media-source-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "media-source-supported",
 			       IPP_TAG_KEYWORD)) != NULL &&
       (count = ippGetCount(attr)) > 1)
   {
@@ -1485,7 +1703,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   else
     strlcpy(ppdname, "Unknown", sizeof(ppdname));
 
-  if ((attr = ippFindAttribute(supported, "media-type-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "media-type-supported",
 			       IPP_TAG_ZERO)) != NULL &&
       (count = ippGetCount(attr)) > 1)
   {
@@ -1515,14 +1733,14 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // ColorModel...
   //
 
-  if ((defattr = ippFindAttribute(supported, "print-color-mode-default",
+  if ((defattr = _ppdIppIndexFind(attr_index, "print-color-mode-default",
 				  IPP_TAG_KEYWORD)) == NULL)
-    defattr = ippFindAttribute(supported, "output-mode-default",
+    defattr = _ppdIppIndexFind(attr_index, "output-mode-default",
 			       IPP_TAG_KEYWORD);
 
-  if ((attr = ippFindAttribute(supported, "print-color-mode-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "print-color-mode-supported",
 			       IPP_TAG_KEYWORD)) == NULL)
-    attr = ippFindAttribute(supported, "output-mode-supported",
+    attr = _ppdIppIndexFind(attr_index, "output-mode-supported",
 			    IPP_TAG_KEYWORD);
 
   human_readable = cfCatalogLookUpOption("print-color-mode",
@@ -1724,7 +1942,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // Duplex...
   //
 
-  if (((attr = ippFindAttribute(supported, "sides-supported",
+  if (((attr = _ppdIppIndexFind(attr_index, "sides-supported",
 				IPP_TAG_KEYWORD)) != NULL &&
        ippContainsString(attr, "two-sided-long-edge")) ||
       (attr == NULL && duplex))
@@ -1752,7 +1970,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 		   (human_readable ? human_readable : "On (Landscape)"));
     cupsFilePrintf(fp, "*CloseUI: *Duplex\n");
 
-    if ((attr = ippFindAttribute(supported, "urf-supported",
+    if ((attr = _ppdIppIndexFind(attr_index, "urf-supported",
 				 IPP_TAG_KEYWORD)) != NULL)
     {
       for (i = 0, count = ippGetCount(attr); i < count; i ++)
@@ -1781,7 +1999,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 	}
       }
     }
-    else if ((attr = ippFindAttribute(supported,
+    else if ((attr = _ppdIppIndexFind(attr_index,
 				      "pwg-raster-document-sheet-back",
 				      IPP_TAG_KEYWORD)) != NULL)
     {
@@ -1802,13 +2020,13 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // Output bin...
   //
 
-  if ((attr = ippFindAttribute(supported, "output-bin-default",
+  if ((attr = _ppdIppIndexFind(attr_index, "output-bin-default",
 			       IPP_TAG_ZERO)) != NULL)
     ppdPwgPpdizeName(ippGetString(attr, 0, NULL), ppdname, sizeof(ppdname));
   else
     strlcpy(ppdname, "Unknown", sizeof(ppdname));
 
-  if ((attr = ippFindAttribute(supported, "output-bin-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "output-bin-supported",
 			       IPP_TAG_ZERO)) != NULL &&
       (count = ippGetCount(attr)) > 0)
   {
@@ -1819,7 +2037,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 		   "*DefaultOutputBin: %s\n",
 		   (human_readable ? human_readable : "Output Bin"),
 		   ppdname);
-    attr2 = ippFindAttribute(supported, "printer-output-tray", IPP_TAG_STRING);
+    attr2 = _ppdIppIndexFind(attr_index, "printer-output-tray", IPP_TAG_STRING);
     for (i = 0; i < count; i ++)
     {
       keyword = ippGetString(attr, i, NULL);
@@ -1886,7 +2104,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // Finishing options...
   //
 
-  if ((attr = ippFindAttribute(supported, "finishings-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "finishings-supported",
 			       IPP_TAG_ENUM)) != NULL)
   {
     int			value;		// Enum value
@@ -2302,7 +2520,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     cupsArrayDelete(names);
   }
 
-  if ((attr = ippFindAttribute(supported, "finishings-col-database",
+  if ((attr = _ppdIppIndexFind(attr_index, "finishings-col-database",
 			       IPP_TAG_BEGIN_COLLECTION)) != NULL)
   {
     ipp_t	*finishing_col;		// Current finishing collection
@@ -2403,7 +2621,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   //
 
   if ((quality =
-       ippFindAttribute(supported, "print-quality-supported",
+       _ppdIppIndexFind(attr_index, "print-quality-supported",
 			IPP_TAG_ENUM)) != NULL)
   {
     human_readable = cfCatalogLookUpOption("print-quality", opt_strings_catalog,
@@ -2449,13 +2667,13 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     // Print Optimization ...
     //
 
-    if ((attr = ippFindAttribute(supported, "print-content-optimize-default",
+    if ((attr = _ppdIppIndexFind(attr_index, "print-content-optimize-default",
 				 IPP_TAG_ZERO)) != NULL)
       strlcpy(ppdname, ippGetString(attr, 0, NULL), sizeof(ppdname));
     else
       strlcpy(ppdname, "auto", sizeof(ppdname));
 
-    if ((attr = ippFindAttribute(supported, "print-content-optimize-supported",
+    if ((attr = _ppdIppIndexFind(attr_index, "print-content-optimize-supported",
 				 IPP_TAG_ZERO)) != NULL &&
 	(count = ippGetCount(attr)) > 1)
     {
@@ -2486,13 +2704,13 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     // Print Rendering Intent ...
     //
 
-    if ((attr = ippFindAttribute(supported, "print-rendering-intent-default",
+    if ((attr = _ppdIppIndexFind(attr_index, "print-rendering-intent-default",
 				 IPP_TAG_ZERO)) != NULL)
       strlcpy(ppdname, ippGetString(attr, 0, NULL), sizeof(ppdname));
     else
       strlcpy(ppdname, "auto", sizeof(ppdname));
 
-    if ((attr = ippFindAttribute(supported, "print-rendering-intent-supported",
+    if ((attr = _ppdIppIndexFind(attr_index, "print-rendering-intent-supported",
 				 IPP_TAG_ZERO)) != NULL &&
 	(count = ippGetCount(attr)) > 1)
     {
@@ -2526,13 +2744,13 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
     // Print Scaling ...
     //
 
-    if ((attr = ippFindAttribute(supported, "print-scaling-default",
+    if ((attr = _ppdIppIndexFind(attr_index, "print-scaling-default",
 				 IPP_TAG_ZERO)) != NULL)
       strlcpy(ppdname, ippGetString(attr, 0, NULL), sizeof(ppdname));
     else
       strlcpy(ppdname, "auto", sizeof(ppdname));
 
-    if ((attr = ippFindAttribute(supported, "print-scaling-supported",
+    if ((attr = _ppdIppIndexFind(attr_index, "print-scaling-supported",
 				 IPP_TAG_ZERO)) != NULL &&
 	(count = ippGetCount(attr)) > 1)
     {
@@ -2595,7 +2813,7 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   // Presets...
   //
 
-  if ((attr = ippFindAttribute(supported, "job-presets-supported",
+  if ((attr = _ppdIppIndexFind(attr_index, "job-presets-supported",
 			       IPP_TAG_BEGIN_COLLECTION)) != NULL)
   {
     for (i = 0, count = ippGetCount(attr); i < count; i ++)
@@ -2798,10 +3016,11 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
 	     (is_fax ? "Fax " : ""));
 
   cupsFileClose(fp);
-  if (opt_strings_catalog)
+  if (opt_strings_catalog && opt_strings_catalog != opt_strings)
     cupsArrayDelete(opt_strings_catalog);
   if (printer_opt_strings_catalog)
     cupsArrayDelete(printer_opt_strings_catalog);
+  _ppdIppIndexDelete(attr_index);
 
   return (buffer);
 
@@ -2817,10 +3036,11 @@ ppdCreatePPDFromIPP2(char         *buffer,          // I - Filename buffer
   if (max_res) free(max_res);
 
   cupsFileClose(fp);
-  if (opt_strings_catalog)
+  if (opt_strings_catalog && opt_strings_catalog != opt_strings)
     cupsArrayDelete(opt_strings_catalog);
   if (printer_opt_strings_catalog)
     cupsArrayDelete(printer_opt_strings_catalog);
+  _ppdIppIndexDelete(attr_index);
   unlink(buffer);
   *buffer = '\0';
 
@@ -2870,6 +3090,426 @@ http_connect(http_t     **http,		// IO - Current HTTP connection
 }
 
 
+//
+// 'ppd_create_ppd_from_ipp2()' - Create a PPD file or copy a recently
+//                                generated one.
+//
+
+static char *				// O - PPD filename or `NULL` on error
+ppd_create_ppd_from_ipp2(
+    char         *buffer,		// I - Filename buffer
+    size_t       bufsize,		// I - Size of filename buffer
+    ipp_t        *supported,		// I - Get-Printer-Attributes response
+    const char   *make_model,		// I - Make and model from DNS-SD
+    const char   *pdl,			// I - List of PDLs from DNS-SD
+    int          color,			// I - Color printer? (from DNS-SD)
+    int          duplex,		// I - Duplex printer? (from DNS-SD)
+    cups_array_t *conflicts,		// I - Array of constraints
+    cups_array_t *sizes,		// I - Media sizes we've added
+    char         *default_pagesize,	// I - Default page size
+    const char   *default_cluster_color,// I - Cluster default color
+    char         *status_msg,		// I - Status message buffer or `NULL`
+    size_t       status_msg_size,	// I - Size of status message buffer
+    cups_array_t *opt_strings)		// I - Standard option UI strings or
+					//     `NULL` to load them
+{
+  unsigned long long	hash = _PPD_HASH_INIT;
+					// Hash of the input (FNV-1a)
+  size_t		ipp_length = 0;	// Length of the hashed IPP values
+  char			*constraint;	// Current constraint
+  _ppd_size_t		*size;		// Current media size
+  int			flags[2];	// Color and duplex flags
+  char			*filename;	// Generated PPD file
+
+
+  if (!buffer || bufsize < 1 || !supported)
+    return (ppd_create_ppd_from_ipp(buffer, bufsize, supported, make_model,
+				    pdl, color, duplex, conflicts, sizes,
+				    default_pagesize, default_cluster_color,
+				    status_msg, status_msg_size,
+				    opt_strings));
+
+  //
+  // Hash everything the generated PPD file depends on...
+  //
+
+  hash = ppd_hash_ipp(hash, supported, 0, &ipp_length);
+
+  flags[0] = color;
+  flags[1] = duplex;
+
+  hash = ppd_hash_string(hash, make_model);
+  hash = ppd_hash_string(hash, pdl);
+  hash = _ppdHashBytes(hash, flags, sizeof(flags));
+  hash = ppd_hash_string(hash, default_pagesize);
+  hash = ppd_hash_string(hash, default_cluster_color);
+  hash = ppd_hash_string(hash, cupsLangGetName(cupsLangDefault()));
+
+  for (constraint = (char *)cupsArrayGetFirst(conflicts); constraint;
+       constraint = (char *)cupsArrayGetNext(conflicts))
+    hash = ppd_hash_string(hash, constraint);
+
+  hash = ppd_hash_string(hash, "");
+
+  for (size = (_ppd_size_t *)cupsArrayGetFirst(sizes); size;
+       size = (_ppd_size_t *)cupsArrayGetNext(sizes))
+  {
+    hash = ppd_hash_string(hash, size->media);
+    hash = _ppdHashBytes(hash, &size->width,
+			  sizeof(_ppd_size_t) - sizeof(size->media));
+  }
+
+  //
+  // Reuse a previously generated PPD file or generate a new one...
+  //
+
+  if ((filename = ppd_generated_copy(hash, ipp_length, buffer, bufsize,
+				     status_msg, status_msg_size)) != NULL)
+    return (filename);
+
+  if ((filename = ppd_create_ppd_from_ipp(buffer, bufsize, supported,
+					  make_model, pdl, color, duplex,
+					  conflicts, sizes, default_pagesize,
+					  default_cluster_color, status_msg,
+					  status_msg_size, opt_strings)) != NULL)
+    ppd_generated_add(hash, ipp_length, filename, status_msg);
+
+  return (filename);
+}
+
+
+//
+// 'ppd_generated_add()' - Remember a generated PPD file.
+//
+
+static void
+ppd_generated_add(
+    unsigned long long hash,		// I - Hash of the generator input
+    size_t             ipp_length,	// I - Length of the hashed IPP values
+    const char         *filename,	// I - Generated PPD file
+    const char         *status_msg)	// I - Status message or `NULL`
+{
+  cups_file_t		*fp;		// PPD file
+  char			*data = NULL,	// PPD file contents
+			*temp;		// New buffer
+  size_t		datalen = 0,	// Length of contents
+			datasize = 0;	// Size of buffer
+  ssize_t		bytes;		// Bytes read
+  int			i;		// Looping var
+  _ppd_generated_t	*g,		// Current generated PPD file
+			*oldest;	// Least recently used PPD file
+
+
+  //
+  // Read the PPD file back in...
+  //
+
+  if ((fp = cupsFileOpen(filename, "r")) == NULL)
+    return;
+
+  do
+  {
+    if (datalen == datasize)
+    {
+      datasize = datasize ? 2 * datasize : 65536;
+
+      if ((temp = realloc(data, datasize)) == NULL)
+      {
+	free(data);
+	cupsFileClose(fp);
+	return;
+      }
+
+      data = temp;
+    }
+
+    if ((bytes = cupsFileRead(fp, data + datalen, datasize - datalen)) > 0)
+      datalen += (size_t)bytes;
+  }
+  while (bytes > 0);
+
+  cupsFileClose(fp);
+
+  if (bytes < 0)
+  {
+    free(data);
+    return;
+  }
+
+  //
+  // Replace the least recently used entry...
+  //
+
+  _ppdMutexLock(&generated_mutex);
+
+  for (i = 0, g = generated, oldest = generated; i < PPD_MAX_GENERATED;
+       i ++, g ++)
+  {
+    if (g->data && g->hash == hash && g->ipp_length == ipp_length)
+    {
+      oldest = g;
+      break;
+    }
+    else if (g->last_used < oldest->last_used)
+      oldest = g;
+  }
+
+  free(oldest->data);
+
+  oldest->hash       = hash;
+  oldest->ipp_length = ipp_length;
+  oldest->last_used  = ++ generated_used;
+  oldest->data       = data;
+  oldest->datalen    = datalen;
+
+  strlcpy(oldest->status_msg, status_msg ? status_msg : "",
+	  sizeof(oldest->status_msg));
+
+  _ppdMutexUnlock(&generated_mutex);
+}
+
+
+//
+// 'ppd_generated_copy()' - Copy a previously generated PPD file to a new
+//                          temporary file.
+//
+
+static char *				// O - PPD filename or `NULL` if none
+ppd_generated_copy(
+    unsigned long long hash,		// I - Hash of the generator input
+    size_t             ipp_length,	// I - Length of the hashed IPP values
+    char               *buffer,		// I - Filename buffer
+    size_t             bufsize,		// I - Size of filename buffer
+    char               *status_msg,	// I - Status message buffer or `NULL`
+    size_t             status_msg_size)	// I - Size of status message buffer
+{
+  int			i;		// Looping var
+  _ppd_generated_t	*g;		// Current generated PPD file
+  cups_file_t		*fp;		// PPD file
+  char			*filename = NULL;
+					// PPD filename
+
+
+  _ppdMutexLock(&generated_mutex);
+
+  for (i = 0, g = generated; i < PPD_MAX_GENERATED; i ++, g ++)
+    if (g->data && g->hash == hash && g->ipp_length == ipp_length)
+      break;
+
+  if (i < PPD_MAX_GENERATED &&
+      (fp = cupsCreateTempFile(NULL, NULL, buffer, (int)bufsize)) != NULL)
+  {
+    if (cupsFileWrite(fp, g->data, g->datalen) < 0)
+    {
+      cupsFileClose(fp);
+      unlink(buffer);
+      *buffer = '\0';
+    }
+    else if (cupsFileClose(fp))
+    {
+      unlink(buffer);
+      *buffer = '\0';
+    }
+    else
+    {
+      g->last_used = ++ generated_used;
+      filename     = buffer;
+
+      generated_hits ++;
+
+      if (status_msg && status_msg_size)
+	strlcpy(status_msg, g->status_msg, status_msg_size);
+    }
+  }
+
+  _ppdMutexUnlock(&generated_mutex);
+
+  return (filename);
+}
+
+
+//
+// 'ppd_hash_ipp()' - Add IPP attributes to a FNV-1a hash.
+//
+// Only the attributes the PPD generator reads are hashed unless "all" is
+// set, which is used for the members of collections.  These are the
+// "xxx-supported", "xxx-default", and similar attributes describing the
+// printer's capabilities, many of which are looked up with names built
+// at run time, and a few printer description attributes.  Status
+// attributes which change while the printer is running are skipped.
+//
+
+static unsigned long long		// O - New hash value
+ppd_hash_ipp(unsigned long long hash,	// I - Current hash value
+             ipp_t              *ipp,	// I - IPP attributes
+	     int                all,	// I - Hash all attributes?
+	     size_t             *length)// IO - Length of hashed values
+{
+  int			i,		// Looping var
+			count;		// Number of values
+  ipp_attribute_t	*attr;		// Current attribute
+  const char		*name,		// Attribute name
+			*suffix;	// Attribute name suffix
+  ipp_tag_t		value_tag;	// Value tag
+  int			ivalues[3];	// Integer values
+  ipp_res_t		units;		// Resolution units
+  const void		*data;		// Octet string value
+  size_t		datalen;	// Length of value
+  static const char * const suffixes[] =
+  {					// Suffixes of capability attributes
+    "-configured",
+    "-database",
+    "-default",
+    "-preferred",
+    "-ready",
+    "-supported"
+  };
+  static const char * const names[] =
+  {					// Other attributes the generator reads
+    "printer-charge-info-uri",
+    "printer-make-and-model",
+    "printer-mandatory-job-attributes",
+    "printer-more-info",
+    "printer-output-tray",
+    "printer-privacy-policy-uri",
+    "printer-requested-job-attributes",
+    "printer-strings-uri",
+    "pwg-raster-document-sheet-back"
+  };
+
+
+  for (attr = ippGetFirstAttribute(ipp); attr;
+       attr = ippGetNextAttribute(ipp))
+  {
+    if ((name = ippGetName(attr)) == NULL)
+      continue;
+
+    if (!all)
+    {
+      if ((suffix = strrchr(name, '-')) != NULL)
+      {
+	for (i = 0; i < (int)(sizeof(suffixes) / sizeof(suffixes[0])); i ++)
+	  if (!strcmp(suffix, suffixes[i]))
+	    break;
+
+	if (i < (int)(sizeof(suffixes) / sizeof(suffixes[0])))
+	  suffix = NULL;
+      }
+
+      if (suffix)
+      {
+	for (i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i ++)
+	  if (!strcmp(name, names[i]))
+	    break;
+
+	if (i >= (int)(sizeof(names) / sizeof(names[0])))
+	  continue;
+      }
+    }
+
+    value_tag = ippGetValueTag(attr);
+    count     = ippGetCount(attr);
+
+    hash = ppd_hash_string(hash, name);
+    hash = _ppdHashBytes(hash, &value_tag, sizeof(value_tag));
+    hash = _ppdHashBytes(hash, &count, sizeof(count));
+
+    *length += strlen(name) + sizeof(value_tag) + sizeof(count);
+
+    for (i = 0; i < count; i ++)
+    {
+      data    = NULL;
+      datalen = 0;
+
+      switch (value_tag)
+      {
+        case IPP_TAG_INTEGER :
+        case IPP_TAG_ENUM :
+	    ivalues[0] = ippGetInteger(attr, i);
+	    data       = ivalues;
+	    datalen    = sizeof(int);
+	    break;
+
+        case IPP_TAG_BOOLEAN :
+	    ivalues[0] = ippGetBoolean(attr, i);
+	    data       = ivalues;
+	    datalen    = sizeof(int);
+	    break;
+
+        case IPP_TAG_RANGE :
+	    ivalues[0] = ippGetRange(attr, i, ivalues + 1);
+	    data       = ivalues;
+	    datalen    = 2 * sizeof(int);
+	    break;
+
+        case IPP_TAG_RESOLUTION :
+	    ivalues[0] = ippGetResolution(attr, i, ivalues + 1, &units);
+	    ivalues[2] = (int)units;
+	    data       = ivalues;
+	    datalen    = 3 * sizeof(int);
+	    break;
+
+        case IPP_TAG_DATE :
+	    data    = ippGetDate(attr, i);
+	    datalen = 11;
+	    break;
+
+        case IPP_TAG_STRING :
+	    data    = ippGetOctetString(attr, i, ivalues);
+	    datalen = data ? (size_t)ivalues[0] : 0;
+	    break;
+
+        case IPP_TAG_BEGIN_COLLECTION :
+	    hash = ppd_hash_ipp(hash, ippGetCollection(attr, i), 1, length);
+	    hash = ppd_hash_string(hash, "");
+	    break;
+
+        case IPP_TAG_TEXT :
+        case IPP_TAG_NAME :
+        case IPP_TAG_KEYWORD :
+        case IPP_TAG_URI :
+        case IPP_TAG_URISCHEME :
+        case IPP_TAG_CHARSET :
+        case IPP_TAG_LANGUAGE :
+        case IPP_TAG_MIMETYPE :
+        case IPP_TAG_TEXTLANG :
+        case IPP_TAG_NAMELANG :
+	    if ((data = ippGetString(attr, i, NULL)) != NULL)
+	      datalen = strlen((const char *)data) + 1;
+	    break;
+
+        default :
+	    break;
+      }
+
+      if (data)
+      {
+	hash    = _ppdHashBytes(hash, data, datalen);
+	*length += datalen;
+      }
+    }
+  }
+
+  return (hash);
+}
+
+
+//
+// 'ppd_hash_string()' - Add a string, including its nul terminator, to a
+//                       FNV-1a hash.
+//
+
+static unsigned long long		// O - New hash value
+ppd_hash_string(unsigned long long hash,// I - Current hash value
+                const char         *s)	// I - String or `NULL`
+{
+  if (!s)
+    return (_ppdHashBytes(hash, "\377", 1));
+  else
+    return (_ppdHashBytes(hash, s, strlen(s) + 1));
+}
+
+
 /*
  * 'ppd_put_strings()' - Write localization attributes to a PPD file.
  */
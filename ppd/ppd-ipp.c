@@ -32,6 +32,8 @@
 // Local functions...
 //
 
+static int		compare_marked(cups_array_t *a, cups_array_t *b);
+static cups_array_t	*copy_marked(ppd_file_t *ppd);
 static ipp_t		*create_media_col(const char *media, const char *source,
 					  const char *type, int width,
 					  int length, int bottom, int left,
@@ -293,6 +295,11 @@ ppdGetOptions(cups_option_t **options,	// O - Options
 //                         to answer a get-printer-attributes IPP
 //                         request.
 //
+// The attributes only depend on the PPD file and its marked choices, so
+// the result is remembered in the PPD file and a copy of it is returned
+// as long as the same choices are marked.  A result is only remembered
+// if building it left the marked choices unchanged.
+//
 
 ipp_t *					// O - IPP attributes or `NULL`
 					//     on error
@@ -342,6 +349,8 @@ ppdLoadAttributes(
                 num,
                 have_custom_size = 0;
   cups_page_header_t header;
+  cups_array_t	*marked,		// Marked choices on entry
+		*after;			// Marked choices when done
   static const char * const pdls[][2] =
   {                                     // MIME media type to command set
 					// mapping
@@ -416,12 +425,32 @@ ppdLoadAttributes(
   if (ppd == NULL)
     return (NULL);
 
+  //
+  // Return a copy of the previous result if the same choices are marked...
+  //
+
+  marked = copy_marked(ppd);
+
+  if (marked && ppd->ipp_attrs &&
+      !compare_marked(marked, ppd->ipp_attrs_marked))
+  {
+    cupsArrayDelete(marked);
+
+    if ((attrs = ippNew()) != NULL)
+      ippCopyAttributes(attrs, ppd->ipp_attrs, 0, NULL, NULL);
+
+    return (attrs);
+  }
+
   if (ppd->cache == NULL)
   {
     if ((pc = ppdCacheCreateWithPPD(ppd)) != NULL)
       ppd->cache = pc;
     else
+    {
+      cupsArrayDelete(marked);
       return (NULL);
+    }
   }
   else
     pc = ppd->cache;
@@ -1502,9 +1531,101 @@ ppdLoadAttributes(
 
   // Clean up
   cupsArrayDelete(docformats);
+
+  //
+  // Remember the attributes for the currently marked choices...
+  //
+  // ppdRasterInterpretPPD() calls ppdHandleMedia(), which can change the
+  // marked choices, and the attributes above were built from both the
+  // choices marked on entry and the ones marked afterwards.  Only keep the
+  // result if the marked choices are still the same as on entry, so that
+  // a later call with these choices marked would build the same attributes
+  // and leave the same choices marked.
+  //
+
+  ippDelete(ppd->ipp_attrs);
+  cupsArrayDelete(ppd->ipp_attrs_marked);
+
+  ppd->ipp_attrs        = NULL;
+  ppd->ipp_attrs_marked = NULL;
+
+  if (marked && (after = copy_marked(ppd)) != NULL)
+  {
+    if (!compare_marked(marked, after) &&
+        (ppd->ipp_attrs = ippNew()) != NULL)
+    {
+      ippCopyAttributes(ppd->ipp_attrs, attrs, 0, NULL, NULL);
+      ppd->ipp_attrs_marked = after;
+      after                 = NULL;
+    }
+
+    cupsArrayDelete(after);
+  }
+
+  cupsArrayDelete(marked);
+
   return (attrs);
 }
 
+
+//
+// 'compare_marked()' - Compare two lists of marked choices.
+//
+
+static int				// O - 0 if equal, 1 otherwise
+compare_marked(cups_array_t *a,		// I - First list
+               cups_array_t *b)		// I - Second list
+{
+  void	*ac,				// Choice in first list
+	*bc;				// Choice in second list
+
+
+  if (cupsArrayGetCount(a) != cupsArrayGetCount(b))
+    return (1);
+
+  for (ac = cupsArrayGetFirst(a), bc = cupsArrayGetFirst(b);
+       ac && bc;
+       ac = cupsArrayGetNext(a), bc = cupsArrayGetNext(b))
+    if (ac != bc)
+      return (1);
+
+  return (0);
+}
+
+
+//
+// 'copy_marked()' - Copy the list of marked choices.
+//
+// Returns `NULL` if a custom choice is marked since its values are not
+// part of the choice itself.
+//
+
+static cups_array_t *			// O - Marked choices or `NULL`
+copy_marked(ppd_file_t *ppd)		// I - PPD file data
+{
+  cups_array_t	*marked;		// Marked choices
+  ppd_choice_t	*c;			// Current choice
+
+
+  if ((marked = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL)) == NULL)
+    return (NULL);
+
+  for (c = (ppd_choice_t *)cupsArrayGetFirst(ppd->marked);
+       c;
+       c = (ppd_choice_t *)cupsArrayGetNext(ppd->marked))
+  {
+    if (!strcasecmp(c->choice, "Custom"))
+    {
+      cupsArrayDelete(marked);
+      return (NULL);
+    }
+
+    cupsArrayAdd(marked, c);
+  }
+
+  return (marked);
+}
+
 //
 // 'create_media_col()' - Create a media-col value.
 //
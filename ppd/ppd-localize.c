@@ -20,11 +20,33 @@
 #include <ppd/libcups2-private.h>
 
 
+//
+// Local types...
+//
+
+typedef struct _ppd_loctext_s		// Text looked up by ppdLocalizeText()
+{
+  char		locale[6],		// Language + country locale
+		keyword[PPD_MAX_NAME],	// Group/option keyword
+		choice[PPD_MAX_NAME];	// Choice or empty string
+  const char	*text;			// Localized text or NULL
+} _ppd_loctext_t;
+
+
 //
 // Local functions...
 //
 
+static int		ppd_compare_loctext(_ppd_loctext_t *a,
+			                    _ppd_loctext_t *b);
+static int		ppd_hash_loctext(_ppd_loctext_t *t);
 static cups_lang_t	*ppd_ll_CC(char *ll_CC, size_t ll_CC_size);
+static int		ppd_locales(const char *ll_CC, char locales[4][6]);
+static ppd_attr_t	*ppd_localized_attr(ppd_file_t *ppd,
+			                    const char *keyword,
+					    const char *spec,
+					    char locales[4][6],
+					    int num_locales);
 
 
 //
@@ -49,7 +71,9 @@ ppdLocalize(ppd_file_t *ppd)		// I - PPD file
   ppd_attr_t	*attr,			// Current attribute
 		*locattr;		// Localized attribute
   char		ckeyword[PPD_MAX_NAME],	// Custom keyword
-		ll_CC[6];		// Language + country locale
+		ll_CC[6],		// Language + country locale
+		locales[4][6];		// Locales to look for
+  int		num_locales;		// Number of locales
 
 
   //
@@ -66,6 +90,7 @@ ppdLocalize(ppd_file_t *ppd)		// I - PPD file
   //
 
   ppd_ll_CC(ll_CC, sizeof(ll_CC));
+  num_locales = ppd_locales(ll_CC, locales);
 
   //
   // Now lookup all of the groups, options, choices, etc.
@@ -73,15 +98,15 @@ ppdLocalize(ppd_file_t *ppd)		// I - PPD file
 
   for (i = ppd->num_groups, group = ppd->groups; i > 0; i --, group ++)
   {
-    if ((locattr = ppdLocalizedAttr(ppd, "Translation", group->name,
-                                     ll_CC)) != NULL)
+    if ((locattr = ppd_localized_attr(ppd, "Translation", group->name,
+                                      locales, num_locales)) != NULL)
       strlcpy(group->text, locattr->text, sizeof(group->text));
 
     for (j = group->num_options, option = group->options; j > 0;
 	 j --, option ++)
     {
-      if ((locattr = ppdLocalizedAttr(ppd, "Translation", option->keyword,
-                                       ll_CC)) != NULL)
+      if ((locattr = ppd_localized_attr(ppd, "Translation", option->keyword,
+                                        locales, num_locales)) != NULL)
 	strlcpy(option->text, locattr->text, sizeof(option->text));
 
       for (k = option->num_choices, choice = option->choices;
@@ -90,13 +115,14 @@ ppdLocalize(ppd_file_t *ppd)		// I - PPD file
       {
         if (strcmp(choice->choice, "Custom") ||
 	    !ppdFindCustomOption(ppd, option->keyword))
-	  locattr = ppdLocalizedAttr(ppd, option->keyword, choice->choice,
-	                              ll_CC);
+	  locattr = ppd_localized_attr(ppd, option->keyword, choice->choice,
+	                               locales, num_locales);
 	else
 	{
 	  snprintf(ckeyword, sizeof(ckeyword), "Custom%.34s", option->keyword);
 
-	  locattr = ppdLocalizedAttr(ppd, ckeyword, "True", ll_CC);
+	  locattr = ppd_localized_attr(ppd, ckeyword, "True", locales,
+	                               num_locales);
 	}
 
         if (locattr)
@@ -120,8 +146,8 @@ ppdLocalize(ppd_file_t *ppd)		// I - PPD file
       snprintf(ckeyword, sizeof(ckeyword), "ParamCustom%.29s",
 	       coption->keyword);
 
-      if ((locattr = ppdLocalizedAttr(ppd, ckeyword, cparam->name,
-                                       ll_CC)) != NULL)
+      if ((locattr = ppd_localized_attr(ppd, ckeyword, cparam->name,
+                                        locales, num_locales)) != NULL)
         strlcpy(cparam->text, locattr->text, sizeof(cparam->text));
     }
   }
@@ -132,8 +158,9 @@ ppdLocalize(ppd_file_t *ppd)		// I - PPD file
 
   if ((attr = ppdFindAttr(ppd, "APCustomColorMatchingName", NULL)) != NULL)
   {
-    if ((locattr = ppdLocalizedAttr(ppd, "APCustomColorMatchingName",
-                                     attr->spec, ll_CC)) != NULL)
+    if ((locattr = ppd_localized_attr(ppd, "APCustomColorMatchingName",
+                                      attr->spec, locales,
+				      num_locales)) != NULL)
       strlcpy(attr->text, locattr->text, sizeof(attr->text));
   }
 
@@ -143,8 +170,8 @@ ppdLocalize(ppd_file_t *ppd)		// I - PPD file
   {
     cupsArraySave(ppd->sorted_attrs);
 
-    if ((locattr = ppdLocalizedAttr(ppd, "cupsICCProfile", attr->spec,
-                                     ll_CC)) != NULL)
+    if ((locattr = ppd_localized_attr(ppd, "cupsICCProfile", attr->spec,
+                                      locales, num_locales)) != NULL)
       strlcpy(attr->text, locattr->text, sizeof(attr->text));
 
     cupsArrayRestore(ppd->sorted_attrs);
@@ -160,8 +187,8 @@ ppdLocalize(ppd_file_t *ppd)		// I - PPD file
   {
     cupsArraySave(ppd->sorted_attrs);
 
-    if ((locattr = ppdLocalizedAttr(ppd, "APPrinterPreset", attr->spec,
-                                     ll_CC)) != NULL)
+    if ((locattr = ppd_localized_attr(ppd, "APPrinterPreset", attr->spec,
+                                      locales, num_locales)) != NULL)
       strlcpy(attr->text, locattr->text, sizeof(attr->text));
 
     cupsArrayRestore(ppd->sorted_attrs);
@@ -473,6 +500,138 @@ ppdLocalizeMarkerName(
 }
 
 
+//
+// 'ppdLocalizeText()' - Get the localized text of a group, option, or
+//                       choice.
+//
+// Unlike @link ppdLocalize@, which replaces the text of all groups,
+// options, choices, and custom parameters at once, this function only
+// looks up the text which is asked for, using the current locale.  Results
+// are kept with the PPD file for each locale, so subsequent calls for the
+// same text are cheap.
+//
+// If "choice" is @code NULL@, the text of the group or option named
+// "keyword" is returned, otherwise the text of the choice of option
+// "keyword".  If there is no translation for the current locale, the text
+// from the main keyword in the PPD file is returned.
+//
+// @since libppd 2.2.0@
+//
+
+const char *				// O - Localized text or @code NULL@ if
+					//     not found
+ppdLocalizeText(ppd_file_t *ppd,	// I - PPD file
+                const char *keyword,	// I - Group or option keyword
+		const char *choice)	// I - Choice or @code NULL@ for the
+					//     group or option itself
+{
+  int			i, j;		// Looping vars
+  _ppd_loctext_t	key,		// Search key
+			*loctext;	// Looked up text
+  ppd_option_t		*option;	// Option
+  ppd_choice_t		*c;		// Choice
+  ppd_group_t		*group,		// Current group
+			*subgroup;	// Current sub-group
+  ppd_attr_t		*locattr;	// Localized attribute
+  char			ckeyword[PPD_MAX_NAME],
+					// Custom keyword
+			locales[4][6];	// Locales to look for
+  int			num_locales;	// Number of locales
+
+
+  DEBUG_printf(("ppdLocalizeText(ppd=%p, keyword=\"%s\", choice=\"%s\")",
+                ppd, keyword, choice));
+
+  //
+  // Range check input...
+  //
+
+  if (!ppd || !keyword)
+    return (NULL);
+
+  //
+  // See if we looked up the text for this locale before...
+  //
+
+  ppd_ll_CC(key.locale, sizeof(key.locale));
+  strlcpy(key.keyword, keyword, sizeof(key.keyword));
+  strlcpy(key.choice, choice ? choice : "", sizeof(key.choice));
+
+  if (!ppd->localized_text &&
+      (ppd->localized_text =
+           cupsArrayNew((cups_array_cb_t)ppd_compare_loctext, NULL,
+	                (cups_ahash_cb_t)ppd_hash_loctext, 256, NULL,
+			(cups_afree_cb_t)free)) == NULL)
+    return (NULL);
+
+  if ((loctext = (_ppd_loctext_t *)cupsArrayFind(ppd->localized_text,
+                                                 &key)) != NULL)
+    return (loctext->text);
+
+  //
+  // No, look it up the same way as ppdLocalize() does...
+  //
+
+  num_locales = ppd_locales(key.locale, locales);
+  key.text    = NULL;
+
+  if ((option = ppdFindOption(ppd, keyword)) != NULL && choice)
+  {
+    if ((c = ppdFindChoice(option, choice)) != NULL)
+    {
+      if (strcmp(c->choice, "Custom") || !ppdFindCustomOption(ppd, keyword))
+	locattr = ppd_localized_attr(ppd, option->keyword, c->choice, locales,
+	                             num_locales);
+      else
+      {
+	snprintf(ckeyword, sizeof(ckeyword), "Custom%.34s", option->keyword);
+
+	locattr = ppd_localized_attr(ppd, ckeyword, "True", locales,
+	                             num_locales);
+      }
+
+      key.text = locattr ? locattr->text : c->text;
+    }
+  }
+  else if (!choice)
+  {
+    if ((locattr = ppd_localized_attr(ppd, "Translation", keyword, locales,
+                                      num_locales)) != NULL)
+      key.text = locattr->text;
+    else if (option)
+      key.text = option->text;
+    else
+    {
+      for (i = ppd->num_groups, group = ppd->groups;
+           i > 0 && !key.text;
+	   i --, group ++)
+      {
+        if (!_ppd_strcasecmp(group->name, keyword))
+	  key.text = group->text;
+
+        for (j = group->num_subgroups, subgroup = group->subgroups;
+	     j > 0 && !key.text;
+	     j --, subgroup ++)
+	  if (!_ppd_strcasecmp(subgroup->name, keyword))
+	    key.text = subgroup->text;
+      }
+    }
+  }
+
+  //
+  // Remember the result, even if nothing was found...
+  //
+
+  if ((loctext = malloc(sizeof(_ppd_loctext_t))) != NULL)
+  {
+    memcpy(loctext, &key, sizeof(_ppd_loctext_t));
+    cupsArrayAdd(ppd->localized_text, loctext);
+  }
+
+  return (key.text);
+}
+
+
 //
 // 'ppdFreeLanguages()' - Free an array of languages from ppdGetLanguages.
 //
@@ -602,76 +761,16 @@ ppdLocalizedAttr(ppd_file_t *ppd,	// I - PPD file
 		  const char *spec,	// I - Option keyword
 		  const char *ll_CC)	// I - Language + country locale
 {
-  char		lkeyword[PPD_MAX_NAME];	// Localization keyword
   ppd_attr_t	*attr;			// Current attribute
+  char		locales[4][6];		// Locales to look for
+  int		num_locales;		// Number of locales
 
 
   DEBUG_printf(("4ppdLocalizedAttr(ppd=%p, keyword=\"%s\", spec=\"%s\", "
                 "ll_CC=\"%s\")", ppd, keyword, spec, ll_CC));
 
-  //
-  // Look for Keyword.ll_CC, then Keyword.ll...
-  //
-
-  snprintf(lkeyword, sizeof(lkeyword), "%s.%s", ll_CC, keyword);
-  if ((attr = ppdFindAttr(ppd, lkeyword, spec)) == NULL)
-  {
-    //
-    // <rdar://problem/22130168>
-    //
-    // Multiple locales need special handling...  Sigh...
-    //
-
-    if (!strcmp(ll_CC, "zh_HK"))
-    {
-      snprintf(lkeyword, sizeof(lkeyword), "zh_TW.%s", keyword);
-      attr = ppdFindAttr(ppd, lkeyword, spec);
-    }
-
-    if (!attr)
-    {
-      snprintf(lkeyword, sizeof(lkeyword), "%2.2s.%s", ll_CC, keyword);
-      attr = ppdFindAttr(ppd, lkeyword, spec);
-    }
-
-    if (!attr)
-    {
-      if (!strncmp(ll_CC, "ja", 2))
-      {
-	//
-	// Due to a bug in the CUPS DDK 1.1.0 ppdmerge program, Japanese
-	// PPD files were incorrectly assigned "jp" as the locale name
-	// instead of "ja".  Support both the old (incorrect) and new
-	// locale names for Japanese...
-	//
-
-	snprintf(lkeyword, sizeof(lkeyword), "jp.%s", keyword);
-	attr = ppdFindAttr(ppd, lkeyword, spec);
-      }
-      else if (!strncmp(ll_CC, "nb", 2))
-      {
-	//
-	// Norway has two languages, "Bokmal" (the primary one)
-	// and "Nynorsk" (new Norwegian); this code maps from the (currently)
-	// recommended "nb" to the previously recommended "no"...
-	//
-
-	snprintf(lkeyword, sizeof(lkeyword), "no.%s", keyword);
-	attr = ppdFindAttr(ppd, lkeyword, spec);
-      }
-      else if (!strncmp(ll_CC, "no", 2))
-      {
-	//
-	// Norway has two languages, "Bokmal" (the primary one)
-	// and "Nynorsk" (new Norwegian); we map "no" to "nb" here as
-	// recommended by the locale folks...
-	//
-
-	snprintf(lkeyword, sizeof(lkeyword), "nb.%s", keyword);
-	attr = ppdFindAttr(ppd, lkeyword, spec);
-      }
-    }
-  }
+  num_locales = ppd_locales(ll_CC, locales);
+  attr        = ppd_localized_attr(ppd, keyword, spec, locales, num_locales);
 
 #ifdef DEBUG
   if (attr)
@@ -685,6 +784,48 @@ ppdLocalizedAttr(ppd_file_t *ppd,	// I - PPD file
 }
 
 
+//
+// 'ppd_compare_loctext()' - Compare two looked up texts.
+//
+
+static int				// O - Result of comparison
+ppd_compare_loctext(_ppd_loctext_t *a,	// I - First text
+                    _ppd_loctext_t *b)	// I - Second text
+{
+  int	diff;				// Difference
+
+
+  if ((diff = strcmp(a->locale, b->locale)) != 0)
+    return (diff);
+  else if ((diff = _ppd_strcasecmp(a->keyword, b->keyword)) != 0)
+    return (diff);
+  else
+    return (_ppd_strcasecmp(a->choice, b->choice));
+}
+
+
+//
+// 'ppd_hash_loctext()' - Generate a hash of a looked up text's keyword and
+//                        choice.
+//
+
+static int				// O - Hash index
+ppd_hash_loctext(_ppd_loctext_t *t)	// I - Text
+{
+  unsigned	hash = 0;		// Hash index
+  const char	*k;			// Pointer into keyword/choice
+
+
+  for (k = t->keyword; *k; k ++)
+    hash = 33U * hash + (unsigned)_ppd_tolower(*k);
+
+  for (k = t->choice; *k; k ++)
+    hash = 33U * hash + (unsigned)_ppd_tolower(*k);
+
+  return ((int)(hash & 255));
+}
+
+
 //
 // 'ppd_ll_CC()' - Get the current locale names.
 //
@@ -735,3 +876,116 @@ ppd_ll_CC(char   *ll_CC,		// O - Country-specific locale name
                 cupsLangGetName(lang), ll_CC));
   return (lang);
 }
+
+
+//
+// 'ppd_locales()' - Get the locales to look for localized attributes of a
+//                   locale, in the order of preference.
+//
+
+static int				// O - Number of locales
+ppd_locales(const char *ll_CC,		// I - Language + country locale
+            char       locales[4][6])	// O - Locales
+{
+  int	num_locales = 0;		// Number of locales
+
+
+  //
+  // Look for Keyword.ll_CC, then Keyword.ll...
+  //
+
+  strlcpy(locales[num_locales ++], ll_CC, sizeof(locales[0]));
+
+  //
+  // <rdar://problem/22130168>
+  //
+  // Multiple locales need special handling...  Sigh...
+  //
+
+  if (!strcmp(ll_CC, "zh_HK"))
+    strlcpy(locales[num_locales ++], "zh_TW", sizeof(locales[0]));
+
+  if (strlen(ll_CC) > 2)
+    snprintf(locales[num_locales ++], sizeof(locales[0]), "%2.2s", ll_CC);
+
+  if (!strncmp(ll_CC, "ja", 2))
+  {
+    //
+    // Due to a bug in the CUPS DDK 1.1.0 ppdmerge program, Japanese
+    // PPD files were incorrectly assigned "jp" as the locale name
+    // instead of "ja".  Support both the old (incorrect) and new
+    // locale names for Japanese...
+    //
+
+    strlcpy(locales[num_locales ++], "jp", sizeof(locales[0]));
+  }
+  else if (!strncmp(ll_CC, "nb", 2))
+  {
+    //
+    // Norway has two languages, "Bokmal" (the primary one)
+    // and "Nynorsk" (new Norwegian); this code maps from the (currently)
+    // recommended "nb" to the previously recommended "no"...
+    //
+
+    strlcpy(locales[num_locales ++], "no", sizeof(locales[0]));
+  }
+  else if (!strncmp(ll_CC, "no", 2))
+  {
+    //
+    // Norway has two languages, "Bokmal" (the primary one)
+    // and "Nynorsk" (new Norwegian); we map "no" to "nb" here as
+    // recommended by the locale folks...
+    //
+
+    strlcpy(locales[num_locales ++], "nb", sizeof(locales[0]));
+  }
+
+  return (num_locales);
+}
+
+
+//
+// 'ppd_localized_attr()' - Find a localized attribute for the first
+//                          matching locale.
+//
+// Localized attributes with a specifier are looked up in the translation
+// table which ppdOpen() builds while reading the PPD file, so each locale
+// costs a single hash lookup.
+//
+
+static ppd_attr_t *			// O - Localized attribute or NULL
+ppd_localized_attr(
+    ppd_file_t *ppd,			// I - PPD file
+    const char *keyword,		// I - Main keyword
+    const char *spec,			// I - Option keyword
+    char       locales[4][6],		// I - Locales to look for
+    int        num_locales)		// I - Number of locales
+{
+  int		i;			// Looping var
+  ppd_attr_t	key,			// Search key
+		*attr = NULL;		// Current attribute
+
+
+  if (!ppd || !keyword)
+    return (NULL);
+
+  if (spec)
+  {
+    if (!ppd->translations)
+      return (NULL);
+
+    strlcpy(key.spec, spec, sizeof(key.spec));
+  }
+
+  for (i = 0; i < num_locales && !attr; i ++)
+  {
+    snprintf(key.name, sizeof(key.name), "%s.%s", locales[i], keyword);
+
+    if (spec)
+      attr = (ppd_attr_t *)cupsArrayFind(ppd->translations, &key);
+    else
+      attr = ppdFindAttr(ppd, key.name, NULL);
+  }
+
+  return (attr);
+}
@@ -20,6 +20,38 @@
 #include <ppd/libcups2-private.h>
 
 
+//
+// Local types...
+//
+
+typedef enum ppd_mark_e			// **** Options with special handling ****
+{
+  PPD_MARK_OTHER,			// Regular PPD option
+  PPD_MARK_APPRINTERPRESET,		// APPrinterPreset
+  PPD_MARK_COLLATE,			// Collate
+  PPD_MARK_FINISHINGS,			// finishings
+  PPD_MARK_MEDIA,			// media
+  PPD_MARK_MEDIATYPE,			// MediaType
+  PPD_MARK_MIRROR,			// mirror
+  PPD_MARK_MULTIPLE_DOCUMENT_HANDLING,	// multiple-document-handling
+  PPD_MARK_OUTPUT_BIN,			// output-bin
+  PPD_MARK_OUTPUT_MODE,			// output-mode
+  PPD_MARK_OUTPUTBIN,			// OutputBin
+  PPD_MARK_PAGESIZE,			// PageSize
+  PPD_MARK_PMSPOOLFORMAT,		// com.apple.print.DocumentTicket.PMSpoolFormat
+  PPD_MARK_PRINT_COLOR_MODE,		// print-color-mode
+  PPD_MARK_PRINT_QUALITY,		// print-quality
+  PPD_MARK_RESOLUTION,			// resolution, printer-resolution
+  PPD_MARK_SIDES			// sides
+} ppd_mark_t;
+
+typedef struct ppd_mark_keyword_s	// **** Option dispatch entry ****
+{
+  const char	*name;			// Option name
+  ppd_mark_t	mark;			// How to handle it
+} ppd_mark_keyword_t;
+
+
 //
 // Local functions...
 //
@@ -31,10 +63,40 @@ static void	ppd_debug_marked(ppd_file_t *ppd, const char *title);
 #endif // DEBUG
 static void	ppd_defaults(ppd_file_t *ppd, ppd_group_t *g);
 static void	ppd_mark_choices(ppd_file_t *ppd, const char *s);
+static ppd_mark_t ppd_mark_classify(const char *name);
+static int	ppd_mark_compare(ppd_mark_keyword_t *a, ppd_mark_keyword_t *b);
 static void	ppd_mark_option(ppd_file_t *ppd, const char *option,
 		                const char *choice);
 
 
+//
+// Local globals...
+//
+// **** THIS LIST MUST BE SORTED CASE-INSENSITIVELY BY NAME ****
+//
+
+static const ppd_mark_keyword_t ppd_mark_keywords[] =
+{
+  { "APPrinterPreset",				PPD_MARK_APPRINTERPRESET },
+  { "Collate",					PPD_MARK_COLLATE },
+  { "com.apple.print.DocumentTicket.PMSpoolFormat", PPD_MARK_PMSPOOLFORMAT },
+  { "finishings",				PPD_MARK_FINISHINGS },
+  { "media",					PPD_MARK_MEDIA },
+  { "MediaType",				PPD_MARK_MEDIATYPE },
+  { "mirror",					PPD_MARK_MIRROR },
+  { "multiple-document-handling",		PPD_MARK_MULTIPLE_DOCUMENT_HANDLING },
+  { "output-bin",				PPD_MARK_OUTPUT_BIN },
+  { "output-mode",				PPD_MARK_OUTPUT_MODE },
+  { "OutputBin",				PPD_MARK_OUTPUTBIN },
+  { "PageSize",					PPD_MARK_PAGESIZE },
+  { "print-color-mode",				PPD_MARK_PRINT_COLOR_MODE },
+  { "print-quality",				PPD_MARK_PRINT_QUALITY },
+  { "printer-resolution",			PPD_MARK_RESOLUTION },
+  { "resolution",				PPD_MARK_RESOLUTION },
+  { "sides",					PPD_MARK_SIDES }
+};
+
+
 //
 // 'ppdMarkOptions()' - Mark command-line options in a PPD file.
 //
@@ -56,11 +118,18 @@ ppdMarkOptions(
   const char	*val,			// Pointer into value
 		*media,			// media option
 		*output_bin,		// output-bin option
+		*output_mode,		// output-mode option
 		*page_size,		// PageSize option
 		*ppd_keyword,		// PPD keyword
 		*print_color_mode,	// print-color-mode option
 		*print_quality,		// print-quality option
 		*sides;			// sides option
+  int		have_collate,		// Collate option given?
+		have_media_type,	// MediaType option given?
+		have_output_bin,	// OutputBin option given?
+		have_preset,		// APPrinterPreset option given?
+		have_spool_format,	// PMSpoolFormat option given?
+		have_source;		// Media source option given?
   cups_option_t	*optptr;		// Current option
   ppd_attr_t	*attr;			// PPD attribute
   ppd_cache_t	*cache;			// PPD cache and mapping data
@@ -76,19 +145,91 @@ ppdMarkOptions(
   ppd_debug_marked(ppd, "Before...");
 
   //
-  // Do special handling for finishings, media, output-bin, output-mode,
-  // print-color-mode, print-quality, and PageSize...
+  // Find the options needing special handling in a single pass over the
+  // list rather than calling cupsGetOption() for each of them.  As with
+  // cupsGetOption(), the first instance of an option wins...
   //
 
-  media         = cupsGetOption("media", num_options, options);
-  output_bin    = cupsGetOption("output-bin", num_options, options);
-  page_size     = cupsGetOption("PageSize", num_options, options);
-  print_quality = cupsGetOption("print-quality", num_options, options);
-  sides         = cupsGetOption("sides", num_options, options);
+  media            = NULL;
+  output_bin       = NULL;
+  output_mode      = NULL;
+  page_size        = NULL;
+  print_color_mode = NULL;
+  print_quality    = NULL;
+  sides            = NULL;
+
+  have_collate      = 0;
+  have_media_type   = 0;
+  have_output_bin   = 0;
+  have_preset       = 0;
+  have_spool_format = 0;
+
+  for (i = num_options, optptr = options; i > 0; i --, optptr ++)
+  {
+    switch (ppd_mark_classify(optptr->name))
+    {
+      case PPD_MARK_APPRINTERPRESET :
+          have_preset = 1;
+	  break;
+
+      case PPD_MARK_COLLATE :
+          have_collate = 1;
+	  break;
+
+      case PPD_MARK_MEDIA :
+          if (!media)
+	    media = optptr->value;
+	  break;
+
+      case PPD_MARK_MEDIATYPE :
+          have_media_type = 1;
+	  break;
+
+      case PPD_MARK_OUTPUT_BIN :
+          if (!output_bin)
+	    output_bin = optptr->value;
+	  break;
+
+      case PPD_MARK_OUTPUT_MODE :
+          if (!output_mode)
+	    output_mode = optptr->value;
+	  break;
+
+      case PPD_MARK_OUTPUTBIN :
+          have_output_bin = 1;
+	  break;
+
+      case PPD_MARK_PAGESIZE :
+          if (!page_size)
+	    page_size = optptr->value;
+	  break;
 
-  if ((print_color_mode = cupsGetOption("print-color-mode", num_options,
-                                        options)) == NULL)
-    print_color_mode = cupsGetOption("output-mode", num_options, options);
+      case PPD_MARK_PMSPOOLFORMAT :
+          have_spool_format = 1;
+	  break;
+
+      case PPD_MARK_PRINT_COLOR_MODE :
+          if (!print_color_mode)
+	    print_color_mode = optptr->value;
+	  break;
+
+      case PPD_MARK_PRINT_QUALITY :
+          if (!print_quality)
+	    print_quality = optptr->value;
+	  break;
+
+      case PPD_MARK_SIDES :
+          if (!sides)
+	    sides = optptr->value;
+	  break;
+
+      default :
+          break;
+    }
+  }
+
+  if (!print_color_mode)
+    print_color_mode = output_mode;
 
   if ((media || output_bin || print_color_mode || print_quality || sides) &&
       !ppd->cache)
@@ -114,6 +255,10 @@ ppdMarkOptions(
     // the size.
     //
 
+    have_source = cache && cache->source_option &&
+                  cupsGetOption(cache->source_option, num_options,
+		                options) != NULL;
+
     for (val = media; *val;)
     {
       //
@@ -140,12 +285,11 @@ ppdMarkOptions(
 	  ppd_mark_option(ppd, "PageSize", ppd_keyword);
       }
 
-      if (cache && cache->source_option &&
-          !cupsGetOption(cache->source_option, num_options, options) &&
+      if (cache && cache->source_option && !have_source &&
 	  (ppd_keyword = ppdCacheGetInputSlot(cache, NULL, s)) != NULL)
 	ppd_mark_option(ppd, cache->source_option, ppd_keyword);
 
-      if (!cupsGetOption("MediaType", num_options, options) &&
+      if (!have_media_type &&
 	  (ppd_keyword = ppdCacheGetMediaType(cache, NULL, s)) != NULL)
 	ppd_mark_option(ppd, "MediaType", ppd_keyword);
     }
@@ -153,9 +297,7 @@ ppdMarkOptions(
 
   if (cache)
   {
-    if (!cupsGetOption("com.apple.print.DocumentTicket.PMSpoolFormat",
-                       num_options, options) &&
-        !cupsGetOption("APPrinterPreset", num_options, options) &&
+    if (!have_spool_format && !have_preset &&
         (print_color_mode || print_quality))
     {
       //
@@ -219,7 +361,7 @@ ppdMarkOptions(
       }
     }
 
-    if (output_bin && !cupsGetOption("OutputBin", num_options, options) &&
+    if (output_bin && !have_output_bin &&
 	(ppd_keyword = ppdCacheGetOutputBin(cache, output_bin)) != NULL)
     {
       //
@@ -253,95 +395,101 @@ ppdMarkOptions(
 
   for (i = num_options, optptr = options; i > 0; i --, optptr ++)
   {
-    if (!_ppd_strcasecmp(optptr->name, "media") ||
-        !_ppd_strcasecmp(optptr->name, "output-bin") ||
-	!_ppd_strcasecmp(optptr->name, "output-mode") ||
-	!_ppd_strcasecmp(optptr->name, "print-quality") ||
-	!_ppd_strcasecmp(optptr->name, "sides"))
-      continue;
-    else if (!_ppd_strcasecmp(optptr->name, "resolution") ||
-             !_ppd_strcasecmp(optptr->name, "printer-resolution"))
-    {
-      ppd_mark_option(ppd, "Resolution", optptr->value);
-      ppd_mark_option(ppd, "SetResolution", optptr->value);
-      	// Calcomp, Linotype, QMS, Summagraphics, Tektronix, Varityper
-      ppd_mark_option(ppd, "JCLResolution", optptr->value);
-      	// HP
-      ppd_mark_option(ppd, "CNRes_PGP", optptr->value);
-      	// Canon
-    }
-    else if (!_ppd_strcasecmp(optptr->name, "multiple-document-handling"))
+    switch (ppd_mark_classify(optptr->name))
     {
-      if (!cupsGetOption("Collate", num_options, options) &&
-          ppdFindOption(ppd, "Collate"))
-      {
-        if (_ppd_strcasecmp(optptr->value,
-			    "separate-documents-uncollated-copies"))
-	  ppd_mark_option(ppd, "Collate", "True");
-	else
-	  ppd_mark_option(ppd, "Collate", "False");
-      }
-    }
-    else if (!_ppd_strcasecmp(optptr->name, "finishings"))
-    {
-      //
-      // Lookup cupsIPPFinishings attributes for each value...
-     
-
-      for (ptr = optptr->value; *ptr;)
-      {
-	//
-        // Get the next finishings number...
-	//
-
-        if (!isdigit(*ptr & 255))
+      case PPD_MARK_MEDIA :
+      case PPD_MARK_OUTPUT_BIN :
+      case PPD_MARK_OUTPUT_MODE :
+      case PPD_MARK_PRINT_QUALITY :
+      case PPD_MARK_SIDES :
+          break;
+
+      case PPD_MARK_RESOLUTION :
+	  ppd_mark_option(ppd, "Resolution", optptr->value);
+	  ppd_mark_option(ppd, "SetResolution", optptr->value);
+	  	// Calcomp, Linotype, QMS, Summagraphics, Tektronix, Varityper
+	  ppd_mark_option(ppd, "JCLResolution", optptr->value);
+	  	// HP
+	  ppd_mark_option(ppd, "CNRes_PGP", optptr->value);
+	  	// Canon
 	  break;
 
-        if ((j = (int)strtol(ptr, &ptr, 10)) < 3)
+      case PPD_MARK_MULTIPLE_DOCUMENT_HANDLING :
+	  if (!have_collate && ppdFindOption(ppd, "Collate"))
+	  {
+	    if (_ppd_strcasecmp(optptr->value,
+				"separate-documents-uncollated-copies"))
+	      ppd_mark_option(ppd, "Collate", "True");
+	    else
+	      ppd_mark_option(ppd, "Collate", "False");
+	  }
 	  break;
 
-	//
-        // Skip separator as needed...
-	//
+      case PPD_MARK_FINISHINGS :
+	  //
+	  // Lookup cupsIPPFinishings attributes for each value...
+	  //
 
-        if (*ptr == ',')
-	  ptr ++;
+	  for (ptr = optptr->value; *ptr;)
+	  {
+	    //
+	    // Get the next finishings number...
+	    //
 
-	//
-        // Look it up in the PPD file...
-	//
+	    if (!isdigit(*ptr & 255))
+	      break;
 
-	sprintf(s, "%d", j);
+	    if ((j = (int)strtol(ptr, &ptr, 10)) < 3)
+	      break;
 
-        if ((attr = ppdFindAttr(ppd, "cupsIPPFinishings", s)) == NULL)
-	  continue;
+	    //
+	    // Skip separator as needed...
+	    //
 
-	//
-        // Apply "*Option Choice" settings from the attribute value...
-	//
+	    if (*ptr == ',')
+	      ptr ++;
 
-        ppd_mark_choices(ppd, attr->value);
-      }
-    }
-    else if (!_ppd_strcasecmp(optptr->name, "APPrinterPreset"))
-    {
-      //
-      // Lookup APPrinterPreset value...
-      //
+	    //
+	    // Look it up in the PPD file...
+	    //
 
-      if ((attr = ppdFindAttr(ppd, "APPrinterPreset", optptr->value)) != NULL)
-      {
-	//
-        // Apply "*Option Choice" settings from the attribute value...
-	//
+	    sprintf(s, "%d", j);
 
-        ppd_mark_choices(ppd, attr->value);
-      }
+	    if ((attr = ppdFindAttr(ppd, "cupsIPPFinishings", s)) == NULL)
+	      continue;
+
+	    //
+	    // Apply "*Option Choice" settings from the attribute value...
+	    //
+
+	    ppd_mark_choices(ppd, attr->value);
+	  }
+	  break;
+
+      case PPD_MARK_APPRINTERPRESET :
+	  //
+	  // Lookup APPrinterPreset value...
+	  //
+
+	  if ((attr = ppdFindAttr(ppd, "APPrinterPreset",
+				  optptr->value)) != NULL)
+	  {
+	    //
+	    // Apply "*Option Choice" settings from the attribute value...
+	    //
+
+	    ppd_mark_choices(ppd, attr->value);
+	  }
+	  break;
+
+      case PPD_MARK_MIRROR :
+	  ppd_mark_option(ppd, "MirrorPrint", optptr->value);
+	  break;
+
+      default :
+	  ppd_mark_option(ppd, optptr->name, optptr->value);
+	  break;
     }
-    else if (!_ppd_strcasecmp(optptr->name, "mirror"))
-      ppd_mark_option(ppd, "MirrorPrint", optptr->value);
-    else
-      ppd_mark_option(ppd, optptr->name, optptr->value);
   }
 
   if (print_quality)
@@ -763,6 +911,45 @@ ppd_mark_choices(ppd_file_t *ppd,	// I - PPD file
 }
 
 
+//
+// 'ppd_mark_classify()' - Look up how an option is handled by
+//                         ppdMarkOptions().
+//
+
+static ppd_mark_t			// O - Option class
+ppd_mark_classify(const char *name)	// I - Option name
+{
+  ppd_mark_keyword_t	key,		// Search key
+			*match;		// Matching keyword
+
+
+  key.name = name;
+
+  if ((match = (ppd_mark_keyword_t *)bsearch(&key, ppd_mark_keywords,
+					     sizeof(ppd_mark_keywords) /
+					     sizeof(ppd_mark_keywords[0]),
+					     sizeof(ppd_mark_keywords[0]),
+					     (int (*)(const void *,
+						      const void *))
+					     ppd_mark_compare)) != NULL)
+    return (match->mark);
+  else
+    return (PPD_MARK_OTHER);
+}
+
+
+//
+// 'ppd_mark_compare()' - Compare two option dispatch entries.
+//
+
+static int				// O - Result of comparison
+ppd_mark_compare(ppd_mark_keyword_t *a,	// I - First entry
+                 ppd_mark_keyword_t *b)	// I - Second entry
+{
+  return (_ppd_strcasecmp(a->name, b->name));
+}
+
+
 //
 // 'ppd_mark_option()' - Quick mark an option without checking for conflicts.
 //
@@ -23,6 +23,11 @@
 #include <math.h>
 #ifdef _WIN32
 #  define X_OK 0
+#else
+#  include <unistd.h>
+#  include <poll.h>
+#  include <signal.h>
+#  include <sys/wait.h>
 #endif // _WIN32
 
 
@@ -63,10 +68,54 @@ enum
 #define MODE_PROGRAM    0555     // Owner/group/other read+exec
 
 
+//
+// Size of hash tables for names...
+//
+
+#define NAME_HASHSIZE    256
+
+
+//
+// Types...
+//
+
+typedef struct ppd_test_job_s    // **** Files tested by one worker ****
+{
+  int pid;                       // Worker process or 0
+  int fd;                        // Pipe with report text from worker
+  char *data;                    // Report text ('\0'-separated lines)
+  size_t datalen,                // Length of report text
+         datasize;               // Allocated size of report text
+  int result;                    // Result of ppdTest() for these files
+  int error;                     // Did we lose report text?
+  int done;                      // Are these files done?
+} ppd_test_job_t;
+
+typedef struct ppd_test_prefix_s // **** Option for common prefix check ****
+{
+  const char *keyword;           // Option keyword
+  int order;                     // Position of option in PPD file
+} ppd_test_prefix_t;
+
+typedef struct ppd_test_probe_s  // **** Cached filesystem probe ****
+{
+  char *path;                    // File or directory
+  int have_stat;                 // Did we stat() the path?
+  int stat_status;               // Result of stat()
+  struct stat fileinfo;          // File information
+  int have_names;                // Did we read the directory?
+  cups_array_t *names;           // Names of directory entries
+} ppd_test_probe_t;
+
+
 //
 // Local functions...
 //
 
+#ifndef _WIN32
+static int add_report_text(ppd_test_job_t *job, const char *text,
+			   size_t len);
+#endif // !_WIN32
 static void check_basics(const char *filename, cups_array_t **report,
 			 cf_logfunc_t log, void *ld);
 static int check_constraints(ppd_file_t *ppd, int errors, int verbose,
@@ -80,25 +129,44 @@ static int check_defaults(ppd_file_t *ppd, int errors, int verbose,
 static int check_duplex(ppd_file_t *ppd, int errors, int verbose,
                         int warn, cups_array_t **report,
 			cf_logfunc_t log, void *ld);
-static int check_filters(ppd_file_t *ppd, const char *root, int errors,
-                         int verbose, int warn, cups_array_t **report,
-			 cf_logfunc_t log, void *ld);
-static int check_profiles(ppd_file_t *ppd, const char *root, int errors,
-                          int verbose, int warn, cups_array_t **report,
-			  cf_logfunc_t log, void *ld);
+static int check_filters(ppd_file_t *ppd, const char *root,
+                         cups_array_t *probes, int errors, int verbose,
+			 int warn, cups_array_t **report, cf_logfunc_t log,
+			 void *ld);
+static int check_profiles(ppd_file_t *ppd, const char *root,
+                          cups_array_t *probes, int errors, int verbose,
+			  int warn, cups_array_t **report, cf_logfunc_t log,
+			  void *ld);
 static int check_sizes(ppd_file_t *ppd, int errors, int verbose, int warn,
 		       cups_array_t **report, cf_logfunc_t log, void *ld);
 static int check_translations(ppd_file_t *ppd, int errors, int verbose,
                               int warn, cups_array_t **report,
 			      cf_logfunc_t log, void *ld);
+static int compare_names(const char *a, const char *b, void *data);
+static int compare_prefix_order(ppd_test_prefix_t *a, ppd_test_prefix_t *b);
+static int compare_prefixes(ppd_test_prefix_t *a, ppd_test_prefix_t *b);
+static int compare_probes(ppd_test_probe_t *a, ppd_test_probe_t *b,
+			  void *data);
+static void free_probe(ppd_test_probe_t *probe, void *data);
+static ppd_test_probe_t *get_probe(cups_array_t *probes, const char *path);
+static int hash_name(const char *s, void *data);
+static int hash_probe(ppd_test_probe_t *probe, void *data);
+static int probe_dir(cups_array_t *probes, const char *dirname,
+		     const char *name);
+static int probe_stat(cups_array_t *probes, const char *path,
+		      struct stat *fileinfo);
 static void show_conflicts(ppd_file_t *ppd, const char *prefix,
 			   cups_array_t **report, cf_logfunc_t log, void *ld);
 static int test_raster(ppd_file_t *ppd, int verbose, cups_array_t **report,
 		       cf_logfunc_t log, void *ld);
-static int valid_path(const char *keyword, const char *path, int errors,
-                      int verbose, int warn, cups_array_t **report,
-		      cf_logfunc_t log, void *ld);
+static int valid_path(const char *keyword, const char *path,
+                      cups_array_t *probes, int errors, int verbose,
+		      int warn, cups_array_t **report, cf_logfunc_t log,
+		      void *ld);
 static int valid_utf8(const char *s);
+#ifndef _WIN32
+static int write_report(int fd, cups_array_t *report);
+#endif // !_WIN32
 
 
 //
@@ -136,9 +204,13 @@ int ppdTest(int ignore,          // Which errors to ignore
   ppd_size_t *size;         // Size record
   ppd_group_t *group;       // UI group
   ppd_option_t *option;     // Standard UI option
-  ppd_group_t *group2;      // UI group
-  ppd_option_t *option2;    // Standard UI option
+  ppd_test_prefix_t *prefixes, // Options sorted by keyword
+                    *matches; // Options sharing a prefix
+  int num_prefixes,         // Number of options
+      num_matches,          // Number of options sharing a prefix
+      lo, hi;               // Bounds of binary search
   ppd_choice_t *choice;     // Standard UI option choice
+  cups_array_t *probes;     // Cached filesystem probes
   struct lconv *loc;        // Locale data
   static char *uis[] = {"BOOLEAN", "PICKONE", "PICKMANY"};
   static char *sections[] = {"ANY", "DOCUMENT", "EXIT",
@@ -176,6 +248,16 @@ int ppdTest(int ignore,          // Which errors to ignore
   if (relaxed == 1)
     ppdSetConformance(PPD_CONFORM_RELAXED);
 
+  //
+  // Filter and profile files are usually shared by many PPD files, so
+  // remember what we found out about them.  Without the cache we just
+  // look at the file system each time...
+  //
+
+  probes = cupsArrayNew((cups_array_cb_t)compare_probes, NULL,
+                        (cups_ahash_cb_t)hash_probe, NAME_HASHSIZE, NULL,
+			(cups_afree_cb_t)free_probe);
+
   //
   // Open the PPD file...
   //
@@ -1467,10 +1549,12 @@ int ppdTest(int ignore,          // Which errors to ignore
       errors = check_constraints(ppd, errors, verbose, 0, report, log, ld);
 
     if (!(warn & PPD_TEST_WARN_FILTERS) && !(ignore & PPD_TEST_WARN_FILTERS))
-      errors = check_filters(ppd, root, errors, verbose, 0, report, log, ld);
+      errors = check_filters(ppd, root, probes, errors, verbose, 0, report,
+			     log, ld);
 
     if (!(warn & PPD_TEST_WARN_PROFILES) && !(ignore & PPD_TEST_WARN_PROFILES))
-      errors = check_profiles(ppd, root, errors, verbose, 0, report, log, ld);
+      errors = check_profiles(ppd, root, probes, errors, verbose, 0, report,
+			      log, ld);
 
     if (!(warn & PPD_TEST_WARN_SIZES))
       errors = check_sizes(ppd, errors, verbose, 0, report, log, ld);
@@ -1647,10 +1731,12 @@ int ppdTest(int ignore,          // Which errors to ignore
 	errors = check_constraints(ppd, errors, verbose, 1, report, log, ld);
 
       if ((warn & PPD_TEST_WARN_FILTERS) && !(ignore & PPD_TEST_WARN_FILTERS))
-	errors = check_filters(ppd, root, errors, verbose, 1, report, log, ld);
+	errors = check_filters(ppd, root, probes, errors, verbose, 1, report,
+			       log, ld);
 
       if ((warn & PPD_TEST_WARN_PROFILES) && !(ignore & PPD_TEST_WARN_PROFILES))
-	errors = check_profiles(ppd, root, errors, verbose, 1, report, log, ld);
+	errors = check_profiles(ppd, root, probes, errors, verbose, 1, report,
+				log, ld);
 
       if (warn & PPD_TEST_WARN_SIZES)
 	errors = check_sizes(ppd, errors, verbose, 1, report, log, ld);
@@ -1828,37 +1914,78 @@ int ppdTest(int ignore,          // Which errors to ignore
       //
       // Check for options with a common prefix, e.g. Duplex and Duplexer,
       // which are errors according to the spec but won't cause problems
-      // with CUPS specifically...
+      // with CUPS specifically.  Once the keywords are sorted, all options
+      // starting with a given keyword directly follow it...
       //
 
-      for (j = 0, group = ppd->groups; j < ppd->num_groups; j ++, group ++)
-	for (k = 0, option = group->options;
-	     k < group->num_options;
-	     k ++, option ++)
-	{
-	  len = strlen(option->keyword);
-
-	  for (m = 0, group2 = ppd->groups;
-	       m < ppd->num_groups;
-	       m ++, group2 ++)
-	    for (n = 0, option2 = group2->options;
-		 n < group2->num_options;
-		 n ++, option2 ++)
-	      if (option != option2 &&
-		  len < strlen(option2->keyword) &&
-		  !strncmp(option->keyword, option2->keyword, len))
-	      {
-		snprintf(str_format, sizeof(str_format) - 1,
-			 ("        WARN    %s shares a common "
-			  "prefix with %s\n"
-			  "                REF: Page 15, section "
-			  "3.2."),
-			 option->keyword, option2->keyword);
-		if (*report)
-		  cupsArrayAdd(*report, (void *)str_format);
-		if (log) log(ld, CF_LOGLEVEL_WARN, "ppdTest: %s", str_format);
-	      }
-	}
+      for (j = 0, num_prefixes = 0, group = ppd->groups;
+	   j < ppd->num_groups;
+	   j ++, group ++)
+	num_prefixes += group->num_options;
+
+      prefixes = calloc((size_t)num_prefixes + 1, sizeof(ppd_test_prefix_t));
+      matches  = calloc((size_t)num_prefixes + 1, sizeof(ppd_test_prefix_t));
+
+      if (prefixes && matches)
+      {
+	for (j = 0, m = 0, group = ppd->groups; j < ppd->num_groups; j ++, group ++)
+	  for (k = 0, option = group->options;
+	       k < group->num_options;
+	       k ++, option ++, m ++)
+	  {
+	    prefixes[m].keyword = option->keyword;
+	    prefixes[m].order   = m;
+	  }
+
+	qsort(prefixes, (size_t)num_prefixes, sizeof(ppd_test_prefix_t),
+	      (int (*)(const void *, const void *))compare_prefixes);
+
+	for (j = 0, group = ppd->groups; j < ppd->num_groups; j ++, group ++)
+	  for (k = 0, option = group->options;
+	       k < group->num_options;
+	       k ++, option ++)
+	  {
+	    len = strlen(option->keyword);
+
+	    for (lo = 0, hi = num_prefixes; lo < hi;)
+	    {
+	      m = (lo + hi) / 2;
+
+	      if (strcmp(prefixes[m].keyword, option->keyword) < 0)
+		lo = m + 1;
+	      else
+		hi = m;
+	    }
+
+	    for (m = lo, num_matches = 0;
+		 m < num_prefixes &&
+		     !strncmp(option->keyword, prefixes[m].keyword, len);
+		 m ++)
+	      if (len < strlen(prefixes[m].keyword))
+		matches[num_matches ++] = prefixes[m];
+
+	    // Report the options in the order of the PPD file...
+	    if (num_matches > 1)
+	      qsort(matches, (size_t)num_matches, sizeof(ppd_test_prefix_t),
+		    (int (*)(const void *, const void *))compare_prefix_order);
+
+	    for (n = 0; n < num_matches; n ++)
+	    {
+	      snprintf(str_format, sizeof(str_format) - 1,
+		       ("        WARN    %s shares a common "
+			"prefix with %s\n"
+			"                REF: Page 15, section "
+			"3.2."),
+		       option->keyword, matches[n].keyword);
+	      if (*report)
+		cupsArrayAdd(*report, (void *)str_format);
+	      if (log) log(ld, CF_LOGLEVEL_WARN, "ppdTest: %s", str_format);
+	    }
+	  }
+      }
+
+      free(prefixes);
+      free(matches);
     }
 
     if (verbose > 0)
@@ -2175,6 +2302,8 @@ int ppdTest(int ignore,          // Which errors to ignore
     ppdClose(ppd);
   }
 
+  cupsArrayDelete(probes);
+
   if (!i)
   {
     if (log) log(ld, CF_LOGLEVEL_ERROR,
@@ -2186,6 +2315,322 @@ int ppdTest(int ignore,          // Which errors to ignore
 }
 
 
+//
+// 'ppdTestFiles()' - Test the correctness of PPD files with several
+//                    processes.
+//
+// This splits "file_array" into at most "jobs" contiguous slices and runs
+// ppdTest() once for each slice in a separate worker process, so that the
+// filesystem probes cached by ppdTest() are shared by the files of a
+// slice.  The report lines of the slices are appended to "report" in the
+// order of "file_array", as ppdTest() would do.  The workers do not call
+// the log function; instead each merged report line is logged with
+// CF_LOGLEVEL_DEBUG.
+//
+// The result is 1 if all files passed, 0 if any file failed, and -1 on
+// error.  With "jobs" less than 2 (or on Windows) this is the same as
+// calling ppdTest().
+//
+
+int                                // O  - 1 = pass, 0 = fail, -1 = error
+ppdTestFiles(int ignore,           // I  - Which errors to ignore
+             int warn,             // I  - Which errors to just warn about
+             char *rootdir,        // I  - Root directory or NULL
+             int verbose,          // I  - Want verbose output?
+             int relaxed,          // I  - Use relaxed mode?
+             int root_present,     // I  - Whether root directory is set
+             cups_array_t *file_array, // I - Filenames of the PPD files
+             int jobs,             // I  - Maximum number of workers
+             cups_array_t **report, // IO - Report array
+	     cf_logfunc_t log,     // I  - Log function
+	     void *ld)             // I  - Log function data
+{
+#ifdef _WIN32
+  return (ppdTest(ignore, warn, rootdir, verbose, relaxed, root_present,
+		  file_array, report, log, ld));
+
+#else
+  int i;                           // Looping var
+  int num_files,                   // Number of files
+      num_jobs,                    // Number of slices
+      next,                        // Next slice to start
+      merged,                      // Number of slices merged into report
+      running,                     // Number of running workers
+      nfds,                        // Number of pipes to poll
+      result = 1;                  // Result
+  ppd_test_job_t *job_array,       // Slices to test
+                 *job;             // Current slice
+  struct pollfd *pfds;             // Pipes of running workers
+  int fds[2];                      // New pipe
+  char *ptr,                       // Pointer into report text
+       *end,                       // End of report text
+       buffer[8192];               // Report text from worker
+  cups_array_t *slice,             // Files of a slice for ppdTest()
+               *slice_report;      // Report of a slice
+  ssize_t bytes;                   // Bytes read from pipe
+  int wstatus;                     // Exit status of worker
+
+
+  if (jobs < 2 || (num_files = cupsArrayGetCount(file_array)) < 2)
+    return (ppdTest(ignore, warn, rootdir, verbose, relaxed, root_present,
+		    file_array, report, log, ld));
+
+  if (report && *report == NULL)
+  {
+    *report = cupsArrayNew(NULL, NULL, NULL, 0,
+                            (cups_acopy_cb_t)_ppdStrAlloc,
+                            (cups_afree_cb_t)_ppdStrFree);
+    if (*report == NULL)
+    {
+      if (log) log(ld, CF_LOGLEVEL_ERROR,
+		   "ppdTest: Could not allocate memory.");
+      return (-1);
+    }
+  }
+
+  num_jobs = jobs < num_files ? jobs : num_files;
+
+  if ((job_array = calloc((size_t)num_jobs, sizeof(ppd_test_job_t))) == NULL ||
+      (pfds = calloc((size_t)num_jobs, sizeof(struct pollfd))) == NULL)
+  {
+    free(job_array);
+    if (log) log(ld, CF_LOGLEVEL_ERROR,
+		 "ppdTest: Could not allocate memory.");
+    return (-1);
+  }
+
+  next    = 0;
+  merged  = 0;
+  running = 0;
+
+  while (merged < num_jobs)
+  {
+    //
+    // Start workers for the next slices, slice "n" gets the files from
+    // n * num_files / num_jobs up to the start of slice n + 1...
+    //
+
+    while (next < num_jobs)
+    {
+      job   = job_array + next;
+      slice = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+
+      for (i = next * num_files / num_jobs;
+           i < (next + 1) * num_files / num_jobs;
+	   i ++)
+        cupsArrayAdd(slice, cupsArrayGetElement(file_array, i));
+
+      next ++;
+
+      if (pipe(fds))
+        job->pid = -1;
+      else if ((job->pid = fork()) == 0)
+      {
+        //
+        // Child comes here, test the files and send the report to the
+	// parent...
+	//
+
+        close(fds[0]);
+
+        slice_report = NULL;
+	i = ppdTest(ignore, warn, rootdir, verbose, relaxed, root_present,
+		    slice, &slice_report, NULL, NULL);
+
+        if (write_report(fds[1], slice_report))
+	  _exit(0);
+
+        _exit(i + 1);
+      }
+      else if (job->pid < 0)
+      {
+        close(fds[0]);
+	close(fds[1]);
+      }
+
+      if (job->pid < 0)
+      {
+        //
+        // Unable to create the worker, test the files here and keep the
+	// report for merging...
+	//
+
+        slice_report = NULL;
+	job->result  = ppdTest(ignore, warn, rootdir, verbose, relaxed,
+			       root_present, slice, &slice_report, NULL,
+			       NULL);
+        job->done    = 1;
+
+	for (ptr = (char *)cupsArrayGetFirst(slice_report);
+	     ptr;
+	     ptr = (char *)cupsArrayGetNext(slice_report))
+	  if (!add_report_text(job, ptr, strlen(ptr) + 1))
+	    job->result = -1;
+
+	cupsArrayDelete(slice_report);
+      }
+      else
+      {
+        close(fds[1]);
+
+        job->fd = fds[0];
+	running ++;
+      }
+
+      cupsArrayDelete(slice);
+    }
+
+    //
+    // Read the report text of the running workers...
+    //
+
+    if (running > 0)
+    {
+      for (nfds = 0, job = job_array + merged; job < job_array + next; job ++)
+	if (job->pid > 0 && !job->done)
+	{
+	  pfds[nfds].fd      = job->fd;
+	  pfds[nfds].events  = POLLIN;
+	  pfds[nfds].revents = 0;
+	  nfds ++;
+	}
+
+      if (poll(pfds, (nfds_t)nfds, -1) < 0 && errno != EINTR)
+        break;
+
+      for (job = job_array + merged; job < job_array + next; job ++)
+      {
+        if (job->pid <= 0 || job->done)
+	  continue;
+
+        for (i = 0; i < nfds; i ++)
+	  if (pfds[i].fd == job->fd)
+	    break;
+
+        if (i >= nfds || !pfds[i].revents)
+	  continue;
+
+        if ((bytes = read(job->fd, buffer, sizeof(buffer))) > 0)
+	{
+	  if (!add_report_text(job, buffer, (size_t)bytes))
+	    job->error = 1;
+	}
+	else if (bytes == 0 || errno != EINTR)
+	{
+	  //
+	  // End of report, collect the worker...
+	  //
+
+	  close(job->fd);
+
+          wstatus = 0;
+	  while (waitpid(job->pid, &wstatus, 0) < 0 && errno == EINTR);
+
+	  if (WIFEXITED(wstatus) && WEXITSTATUS(wstatus) > 0 && !job->error)
+	    job->result = WEXITSTATUS(wstatus) - 1;
+	  else
+	    job->result = -1;
+
+          job->done = 1;
+	  running --;
+	}
+      }
+    }
+
+    //
+    // Merge the reports of finished slices in the order of "file_array"...
+    //
+
+    for (job = job_array + merged;
+         merged < num_jobs && job->done;
+	 merged ++, job ++)
+    {
+      if (job->result < 0)
+        result = -1;
+      else if (job->result == 0 && result > 0)
+        result = 0;
+
+      for (ptr = job->data, end = job->data + job->datalen;
+           ptr && ptr < end;
+	   ptr += strlen(ptr) + 1)
+      {
+        if (*report)
+	  cupsArrayAdd(*report, ptr);
+        if (log) log(ld, CF_LOGLEVEL_DEBUG, "ppdTest: %s", ptr);
+      }
+
+      free(job->data);
+      job->data = NULL;
+    }
+  }
+
+  if (merged < num_jobs)
+  {
+    //
+    // Something went wrong, stop the remaining workers...
+    //
+
+    for (job = job_array + merged; job < job_array + next; job ++)
+    {
+      if (job->pid > 0 && !job->done)
+      {
+        close(job->fd);
+	kill(job->pid, SIGTERM);
+	while (waitpid(job->pid, &wstatus, 0) < 0 && errno == EINTR);
+      }
+
+      free(job->data);
+    }
+
+    if (log) log(ld, CF_LOGLEVEL_ERROR,
+		 "ppdTest: Unable to collect test results - %s",
+		 strerror(errno));
+    result = -1;
+  }
+
+  free(job_array);
+  free(pfds);
+
+  return (result);
+#endif // _WIN32
+}
+
+
+#ifndef _WIN32
+//
+// 'add_report_text()' - Add report text of a file to ppdTestFiles().
+//
+
+static int                         // O - 1 on success, 0 on error
+add_report_text(ppd_test_job_t *job, // I - File
+                const char *text,  // I - Report text
+                size_t len)        // I - Length of report text
+{
+  size_t datasize;                 // New size of buffer
+  char *data;                      // New buffer
+
+
+  if (job->datalen + len > job->datasize)
+  {
+    for (datasize = job->datasize ? job->datasize : 4096;
+         datasize < job->datalen + len;
+	 datasize *= 2);
+
+    if ((data = realloc(job->data, datasize)) == NULL)
+      return (0);
+
+    job->data     = data;
+    job->datasize = datasize;
+  }
+
+  memcpy(job->data + job->datalen, text, len);
+  job->datalen += len;
+
+  return (1);
+}
+#endif // !_WIN32
+
+
 //
 // 'check_basics()' - Check for CR LF, mixed line endings, and blank lines.
 //
@@ -2703,22 +3148,37 @@ check_case(ppd_file_t *ppd,       // I - PPD file
 	   cf_logfunc_t log,      // I - Log function
 	   void *ld)              // I - Log function data
 {
-  int i, j;              // Looping vars
-  ppd_group_t *groupa,   // First group
-        *groupb;         // Second group
+  int i;                 // Looping var
+  ppd_group_t *groupa;   // First group
   ppd_option_t *optiona, // First option
         *optionb;        // Second option
-  ppd_choice_t *choicea, // First choice
-        *choiceb;        // Second choice
+  ppd_choice_t *choicea; // First choice
+  cups_array_t *names;   // Names, ignoring case
+  char *nameb;           // Second name
   char str_format[2048]; // Formatted string
 
+
+  //
+  // Names which only differ by case are found with a hashed array of the
+  // names; names which compare equal are kept in the order they are added,
+  // so each name only needs to be compared with the names following it...
+  //
+
+  names = cupsArrayNew((cups_array_cb_t)compare_names, NULL,
+		       (cups_ahash_cb_t)hash_name, NAME_HASHSIZE, NULL, NULL);
+
   //
   // Check that the groups do not have any duplicate names...
   //
 
+  for (i = ppd->num_groups, groupa = ppd->groups; i > 0; i --, groupa ++)
+    cupsArrayAdd(names, groupa->name);
+
   for (i = ppd->num_groups, groupa = ppd->groups; i > 1; i --, groupa ++)
-    for (j = i - 1, groupb = groupa + 1; j > 0; j --, groupb ++)
-      if (!_ppd_strcasecmp(groupa->name, groupb->name))
+    for (nameb = (char *)cupsArrayFind(names, groupa->name);
+	 nameb && !_ppd_strcasecmp(groupa->name, nameb);
+	 nameb = (char *)cupsArrayGetNext(names))
+      if (nameb > groupa->name)
       {
         if (!errors && !verbose)
         {
@@ -2733,7 +3193,7 @@ check_case(ppd_file_t *ppd,       // I - PPD file
           snprintf(str_format, sizeof(str_format) - 1,
 		   ("      **FAIL**  Group names %s and %s differ only "
 		    "by case."),
-		   groupa->name, groupb->name);
+		   groupa->name, nameb);
           if (*report)
             cupsArrayAdd(*report, (void *)str_format);
           if (log) log(ld, CF_LOGLEVEL_DEBUG, "ppdTest: %s", str_format);
@@ -2743,14 +3203,17 @@ check_case(ppd_file_t *ppd,       // I - PPD file
       }
 
   //
-  // Check that the options do not have any duplicate names...
+  // Check that the options do not have any duplicate names; the options
+  // array is sorted without regard to case, so only the options directly
+  // following an option can match it...
   //
 
   for (optiona = ppdFirstOption(ppd); optiona; optiona = ppdNextOption(ppd))
   {
     cupsArraySave(ppd->options);
-    for (optionb = ppdNextOption(ppd); optionb; optionb = ppdNextOption(ppd))
-      if (!_ppd_strcasecmp(optiona->keyword, optionb->keyword))
+    for (optionb = ppdNextOption(ppd);
+	 optionb && !_ppd_strcasecmp(optiona->keyword, optionb->keyword);
+	 optionb = ppdNextOption(ppd))
       {
 	if (!errors && !verbose)
 	{
@@ -2780,11 +3243,22 @@ check_case(ppd_file_t *ppd,       // I - PPD file
     // Then the choices...
     //
 
+    cupsArrayClear(names);
+
+    for (i = optiona->num_choices, choicea = optiona->choices;
+	 i > 0;
+	 i --, choicea ++)
+      cupsArrayAdd(names, choicea->choice);
+
     for (i = optiona->num_choices, choicea = optiona->choices;
 	 i > 1;
 	 i --, choicea ++)
-      for (j = i - 1, choiceb = choicea + 1; j > 0; j --, choiceb ++)
-	if (!strcmp(choicea->choice, choiceb->choice))
+      for (nameb = (char *)cupsArrayFind(names, choicea->choice);
+	   nameb && !_ppd_strcasecmp(choicea->choice, nameb);
+	   nameb = (char *)cupsArrayGetNext(names))
+	if (nameb <= choicea->choice)
+	  continue;
+	else if (!strcmp(choicea->choice, nameb))
 	{
 	  if (!errors && !verbose)
 	  {
@@ -2811,7 +3285,7 @@ check_case(ppd_file_t *ppd,       // I - PPD file
 	  i --;
 	  break;
 	}
-	else if (!_ppd_strcasecmp(choicea->choice, choiceb->choice))
+	else
 	{
 	  if (!errors && !verbose)
 	    {
@@ -2826,7 +3300,7 @@ check_case(ppd_file_t *ppd,       // I - PPD file
 	    snprintf(str_format, sizeof(str_format) - 1,
 		     ("      **FAIL**  Option %s choice names %s and "
 		      "%s differ only by case."),
-		     optiona->keyword, choicea->choice, choiceb->choice);
+		     optiona->keyword, choicea->choice, nameb);
 	    if (*report)
 	      cupsArrayAdd(*report, (void *)str_format);
 	    if (log) log(ld, CF_LOGLEVEL_DEBUG, "ppdTest: %s", str_format);
@@ -2836,6 +3310,8 @@ check_case(ppd_file_t *ppd,       // I - PPD file
 	}
   }
 
+  cupsArrayDelete(names);
+
   //
   // Return the number of errors found...
   //
@@ -3046,6 +3522,7 @@ check_duplex(ppd_file_t *ppd,       // I - PPD file
 static int                           // O - Errors found
 check_filters(ppd_file_t *ppd,       // I - PPD file
               const char *root,      // I - Root directory
+              cups_array_t *probes,  // I - Cached filesystem probes
               int errors,            // I - Errors found
               int verbose,           // I - Verbosity level
               int warn,              // I - Warnings only?
@@ -3185,7 +3662,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
 		   program);
       }
 
-      if (stat(pathprog, &fileinfo))
+      if (probe_stat(probes, pathprog, &fileinfo))
       {
         if (!warn && !errors && !verbose)
         {
@@ -3234,8 +3711,8 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
           errors ++;
       }
       else
-        errors = valid_path("cupsFilter", pathprog, errors, verbose, warn,
-			    report, log, ld);
+        errors = valid_path("cupsFilter", pathprog, probes, errors,
+                            verbose, warn, report, log, ld);
     }
   }
 
@@ -3365,7 +3842,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
 		   program);
       }
 
-      if (stat(pathprog, &fileinfo))
+      if (probe_stat(probes, pathprog, &fileinfo))
       {
         if (!warn && !errors && !verbose)
         {
@@ -3414,8 +3891,8 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
           errors ++;
       }
       else
-        errors = valid_path("cupsFilter2", pathprog, errors, verbose, warn,
-			    report, log, ld);
+        errors = valid_path("cupsFilter2", pathprog, probes, errors,
+                            verbose, warn, report, log, ld);
     }
   }
 
@@ -3493,7 +3970,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
 		   program);
       }
 
-      if (stat(pathprog, &fileinfo))
+      if (probe_stat(probes, pathprog, &fileinfo))
       {
         if (!warn && !errors && !verbose)
         {
@@ -3542,8 +4019,8 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
           errors ++;
       }
       else
-        errors = valid_path("cupsPreFilter", pathprog, errors, verbose, warn,
-			    report, log, ld);
+        errors = valid_path("cupsPreFilter", pathprog, probes, errors,
+                            verbose, warn, report, log, ld);
     }
   }
 
@@ -3583,7 +4060,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
     snprintf(pathprog, sizeof(pathprog), "%s%s", root,
 	     attr->value ? attr->value : "(null)");
 
-    if (!attr->value || stat(pathprog, &fileinfo))
+    if (!attr->value || probe_stat(probes, pathprog, &fileinfo))
     {
       if (!warn && !errors && !verbose)
       {
@@ -3632,8 +4109,8 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
         errors ++;
     }
     else
-      errors = valid_path("APDialogExtension", pathprog, errors, verbose,
-                          warn, report, log, ld);
+      errors = valid_path("APDialogExtension", pathprog, probes, errors,
+                          verbose, warn, report, log, ld);
   }
 
   //
@@ -3669,7 +4146,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
     snprintf(pathprog, sizeof(pathprog), "%s%s", root,
 	     attr->value ? attr->value : "(null)");
 
-    if (!attr->value || stat(pathprog, &fileinfo))
+    if (!attr->value || probe_stat(probes, pathprog, &fileinfo))
     {
       if (!warn && !errors && !verbose)
       {
@@ -3718,8 +4195,8 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
         errors ++;
     }
     else
-      errors = valid_path("APPrinterIconPath", pathprog, errors, verbose,
-                          warn, report, log, ld);
+      errors = valid_path("APPrinterIconPath", pathprog, probes, errors,
+                          verbose, warn, report, log, ld);
   }
 
   //
@@ -3755,7 +4232,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
     snprintf(pathprog, sizeof(pathprog), "%s%s", root,
 	     attr->value ? attr->value : "(null)");
 
-    if (!attr->value || stat(pathprog, &fileinfo))
+    if (!attr->value || probe_stat(probes, pathprog, &fileinfo))
     {
       if (!warn && !errors && !verbose)
       {
@@ -3804,8 +4281,8 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
         errors ++;
     }
     else
-      errors = valid_path("APPrinterLowInkTool", pathprog, errors, verbose,
-                          warn, report, log, ld);
+      errors = valid_path("APPrinterLowInkTool", pathprog, probes, errors,
+                          verbose, warn, report, log, ld);
   }
 
   //
@@ -3841,7 +4318,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
     snprintf(pathprog, sizeof(pathprog), "%s%s", root,
 	     attr->value ? attr->value : "(null)");
 
-    if (!attr->value || stat(pathprog, &fileinfo))
+    if (!attr->value || probe_stat(probes, pathprog, &fileinfo))
     {
       if (!warn && !errors && !verbose)
       {
@@ -3890,8 +4367,8 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
         errors ++;
     }
     else
-      errors = valid_path("APPrinterUtilityPath", pathprog, errors, verbose,
-                          warn, report, log, ld);
+      errors = valid_path("APPrinterUtilityPath", pathprog, probes, errors,
+                          verbose, warn, report, log, ld);
   }
 
   //
@@ -3924,7 +4401,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
         errors ++;
     }
 
-    if (!attr->value || stat(attr->value, &fileinfo))
+    if (!attr->value || probe_stat(probes, attr->value, &fileinfo))
     {
       if (!warn && !errors && !verbose)
       {
@@ -3974,8 +4451,8 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
         errors ++;
     }
     else
-      errors = valid_path("APScanAppPath", attr->value, errors, verbose,
-                          warn, report, log, ld);
+      errors = valid_path("APScanAppPath", attr->value, probes, errors,
+                          verbose, warn, report, log, ld);
 
     if (ppdFindAttr(ppd, "APScanAppBundleID", NULL))
     {
@@ -4015,6 +4492,7 @@ check_filters(ppd_file_t *ppd,       // I - PPD file
 static int                            // O - Errors found
 check_profiles(ppd_file_t *ppd,       // I - PPD file
                const char *root,      // I - Root directory
+               cups_array_t *probes,  // I - Cached filesystem probes
                int errors,            // I - Errors found
                int verbose,           // I - Verbosity level
                int warn,              // I - Warnings only?
@@ -4093,7 +4571,7 @@ check_profiles(ppd_file_t *ppd,       // I - PPD file
 		 attr->value);
     }
 
-    if (stat(filename, &fileinfo))
+    if (probe_stat(probes, filename, &fileinfo))
     {
       if (!warn && !errors && !verbose)
       {
@@ -4142,8 +4620,8 @@ check_profiles(ppd_file_t *ppd,       // I - PPD file
         errors ++;
     }
     else
-      errors = valid_path("cupsICCProfile", filename, errors, verbose, warn,
-			  report, log, ld);
+      errors = valid_path("cupsICCProfile", filename, probes, errors,
+                          verbose, warn, report, log, ld);
 
     //
     // Check for hash collisions...
@@ -4581,8 +5059,10 @@ check_translations(ppd_file_t *ppd,       // I - PPD file
       keyword[PPD_MAX_NAME],   // Localization keyword (full)
       llkeyword[PPD_MAX_NAME], // Localization keyword (base)
       ckeyword[PPD_MAX_NAME],  // Custom option keyword (full)
-      cllkeyword[PPD_MAX_NAME];
+      cllkeyword[PPD_MAX_NAME],
   // Custom option keyword (base)
+      tkeyword[PPD_MAX_NAME],  // Option translation keyword (full)
+      lltkeyword[PPD_MAX_NAME]; // Option translation keyword (base)
   ppd_option_t *option;        // Standard UI option
   ppd_coption_t *coption;      // Custom option
   ppd_cparam_t *cparam;        // Custom parameter
@@ -4635,6 +5115,8 @@ check_translations(ppd_file_t *ppd,       // I - PPD file
 	continue;
 
       strlcpy(ll, language, sizeof(ll));
+      snprintf(tkeyword, sizeof(tkeyword), "%s.Translation", language);
+      snprintf(lltkeyword, sizeof(lltkeyword), "%s.Translation", ll);
 
       //
       // Loop through all options and choices...
@@ -4647,11 +5129,8 @@ check_translations(ppd_file_t *ppd,       // I - PPD file
 	if (!strcmp(option->keyword, "PageRegion"))
 	  continue;
 
-	snprintf(keyword, sizeof(keyword), "%s.Translation", language);
-	snprintf(llkeyword, sizeof(llkeyword), "%s.Translation", ll);
-
-	if ((attr = ppdFindAttr(ppd, keyword, option->keyword)) == NULL &&
-            (attr = ppdFindAttr(ppd, llkeyword, option->keyword)) == NULL)
+	if ((attr = ppdFindAttr(ppd, tkeyword, option->keyword)) == NULL &&
+            (attr = ppdFindAttr(ppd, lltkeyword, option->keyword)) == NULL)
 	{
 	  if (!warn && !errors && !verbose)
 	  {
@@ -4948,6 +5427,230 @@ check_translations(ppd_file_t *ppd,       // I - PPD file
   return (errors);
 }
 
+//
+// 'compare_names()' - Compare two names without regard to case.
+//
+
+static int                 // O - Result of comparison
+compare_names(const char *a, // I - First name
+              const char *b, // I - Second name
+              void *data)  // I - Callback data (unused)
+{
+  (void)data;
+
+  return (_ppd_strcasecmp(a, b));
+}
+
+
+//
+// 'compare_prefix_order()' - Compare the positions of two options.
+//
+
+static int                 // O - Result of comparison
+compare_prefix_order(ppd_test_prefix_t *a, // I - First option
+                     ppd_test_prefix_t *b) // I - Second option
+{
+  return (a->order - b->order);
+}
+
+
+//
+// 'compare_prefixes()' - Compare the keywords of two options.
+//
+
+static int                 // O - Result of comparison
+compare_prefixes(ppd_test_prefix_t *a, // I - First option
+                 ppd_test_prefix_t *b) // I - Second option
+{
+  int result;              // Result of comparison
+
+
+  if ((result = strcmp(a->keyword, b->keyword)) == 0)
+    result = a->order - b->order;
+
+  return (result);
+}
+
+
+//
+// 'compare_probes()' - Compare the paths of two filesystem probes.
+//
+
+static int                       // O - Result of comparison
+compare_probes(ppd_test_probe_t *a, // I - First probe
+               ppd_test_probe_t *b, // I - Second probe
+               void *data)       // I - Callback data (unused)
+{
+  (void)data;
+
+  return (strcmp(a->path, b->path));
+}
+
+
+//
+// 'free_probe()' - Free a filesystem probe.
+//
+
+static void
+free_probe(ppd_test_probe_t *probe, // I - Probe
+           void *data)           // I - Callback data (unused)
+{
+  (void)data;
+
+  cupsArrayDelete(probe->names);
+  free(probe->path);
+  free(probe);
+}
+
+
+//
+// 'get_probe()' - Find or add the filesystem probe for a path.
+//
+
+static ppd_test_probe_t *        // O - Probe or NULL
+get_probe(cups_array_t *probes,  // I - Cached filesystem probes
+          const char *path)      // I - File or directory
+{
+  ppd_test_probe_t key,          // Search key
+                   *probe;       // Matching probe
+
+
+  if (!probes)
+    return (NULL);
+
+  key.path = (char *)path;
+
+  if ((probe = (ppd_test_probe_t *)cupsArrayFind(probes, &key)) != NULL)
+    return (probe);
+
+  if ((probe = calloc(1, sizeof(ppd_test_probe_t))) == NULL)
+    return (NULL);
+
+  if ((probe->path = strdup(path)) == NULL)
+  {
+    free(probe);
+    return (NULL);
+  }
+
+  cupsArrayAdd(probes, probe);
+
+  return (probe);
+}
+
+
+//
+// 'hash_name()' - Compute the hash of a name without regard to case.
+//
+
+static int                 // O - Hash value
+hash_name(const char *s,   // I - Name
+          void *data)      // I - Callback data (unused)
+{
+  (void)data;
+
+  return ((int)(_ppdHashString(s, 1) % NAME_HASHSIZE));
+}
+
+
+//
+// 'hash_probe()' - Compute the hash of the path of a filesystem probe.
+//
+
+static int                       // O - Hash value
+hash_probe(ppd_test_probe_t *probe, // I - Probe
+           void *data)           // I - Callback data (unused)
+{
+  (void)data;
+
+  return ((int)(_ppdHashString(probe->path, 0) % NAME_HASHSIZE));
+}
+
+
+//
+// 'probe_dir()' - Check whether a directory has an entry with a name.
+//
+// The directory is only read once, later checks use the cached list of
+// entries.
+//
+
+static int                       // O - 1 if entry exists, 0 otherwise
+probe_dir(cups_array_t *probes,  // I - Cached filesystem probes
+          const char *dirname,   // I - Directory
+          const char *name)      // I - Name of entry
+{
+  ppd_test_probe_t *probe;       // Probe for directory
+  cups_dir_t *dir;               // Directory
+  cups_dentry_t *dentry;         // Directory entry
+
+
+  if ((probe = get_probe(probes, dirname)) != NULL && !probe->have_names &&
+      (probe->names = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0,
+                                   (cups_acopy_cb_t)_ppdStrAlloc,
+                                   (cups_afree_cb_t)_ppdStrFree)) != NULL)
+  {
+    probe->have_names = 1;
+
+    if ((dir = cupsDirOpen(dirname)) != NULL)
+    {
+      while ((dentry = cupsDirRead(dir)) != NULL)
+        cupsArrayAdd(probe->names, dentry->filename);
+
+      cupsDirClose(dir);
+    }
+  }
+
+  if (probe && probe->have_names)
+    return (cupsArrayFind(probe->names, (void *)name) != NULL);
+
+  //
+  // No cache, scan the directory...
+  //
+
+  if ((dir = cupsDirOpen(dirname)) == NULL)
+    return (0);
+
+  while ((dentry = cupsDirRead(dir)) != NULL)
+  {
+    if (!strcmp(dentry->filename, name))
+      break;
+  }
+
+  cupsDirClose(dir);
+
+  return (dentry != NULL);
+}
+
+
+//
+// 'probe_stat()' - Get the information of a file like stat() does.
+//
+// The file is only looked at once, later checks use the cached result.
+//
+
+static int                       // O - 0 on success, -1 on error
+probe_stat(cups_array_t *probes, // I - Cached filesystem probes
+           const char *path,     // I - File
+           struct stat *fileinfo) // O - File information
+{
+  ppd_test_probe_t *probe;       // Probe for file
+
+
+  if ((probe = get_probe(probes, path)) == NULL)
+    return (stat(path, fileinfo));
+
+  if (!probe->have_stat)
+  {
+    probe->have_stat   = 1;
+    probe->stat_status = stat(path, &probe->fileinfo);
+  }
+
+  if (!probe->stat_status)
+    *fileinfo = probe->fileinfo;
+
+  return (probe->stat_status);
+}
+
+
 //
 // 'show_conflicts()' - Show option conflicts in a PPD file.
 //
@@ -5141,6 +5844,7 @@ test_raster(ppd_file_t *ppd,       // I - PPD file
 static int                        // O - Errors found
 valid_path(const char *keyword,   // I - Keyword using path
            const char *path,      // I - Path to check
+           cups_array_t *probes,  // I - Cached filesystem probes
            int errors,            // I - Errors found
            int verbose,           // I - Verbosity level
            int warn,              // I - Warnings only?
@@ -5148,8 +5852,6 @@ valid_path(const char *keyword,   // I - Keyword using path
 	   cf_logfunc_t log,      // I - Log function
 	   void *ld)              // I - Log function data
 {
-  cups_dir_t *dir;       // Current directory
-  cups_dentry_t *dentry; // Current directory entry
   char temp[1024],       // Temporary path
       *ptr;              // Pointer into temporary path
   const char *prefix;    // WARN/FAIL prefix
@@ -5173,34 +5875,12 @@ valid_path(const char *keyword,   // I - Keyword using path
 
     *ptr++ = '\0';
 
-    //
-    // Try opening the directory containing the base name...
-    //
-
-    if (temp[0])
-      dir = cupsDirOpen(temp);
-    else
-      dir = cupsDirOpen("/");
-
-    if (!dir)
-      dentry = NULL;
-    else
-    {
-      while ((dentry = cupsDirRead(dir)) != NULL)
-      {
-        if (!strcmp(dentry->filename, ptr))
-          break;
-      }
-
-      cupsDirClose(dir);
-    }
-
     //
     // Display an error if the filename doesn't exist with the same
-    // capitalization...
+    // capitalization in the directory containing it...
     //
 
-    if (!dentry)
+    if (!probe_dir(probes, temp[0] ? temp : "/", ptr))
     {
       if (!warn && !errors && !verbose)
       {
@@ -5305,3 +5985,48 @@ valid_utf8(const char *s) // I - String to check
 
   return (1);
 }
+
+
+#ifndef _WIN32
+//
+// 'write_report()' - Send the report of a worker to ppdTestFiles().
+//
+
+static int                          // O - 0 on success, -1 on error
+write_report(int fd,                // I - Pipe to parent
+             cups_array_t *report)  // I - Report array
+{
+  const char *line,                 // Current line
+             *ptr;                  // Pointer into line
+  size_t len;                       // Bytes left to write
+  ssize_t bytes;                    // Bytes written
+
+
+  for (line = (const char *)cupsArrayGetFirst(report);
+       line;
+       line = (const char *)cupsArrayGetNext(report))
+  {
+    //
+    // Send each line with its nul terminator...
+    //
+
+    for (ptr = line, len = strlen(line) + 1; len > 0; ptr += bytes, len -= (size_t)bytes)
+    {
+      if ((bytes = write(fd, ptr, len)) < 0)
+      {
+        if (errno == EINTR)
+	{
+	  bytes = 0;
+	  continue;
+	}
+
+        return (-1);
+      }
+    }
+  }
+
+  close(fd);
+
+  return (0);
+}
+#endif // !_WIN32
@@ -78,6 +78,8 @@ static int		ppd_compare_choices(ppd_choice_t *a, ppd_choice_t *b);
 static int		ppd_compare_coptions(ppd_coption_t *a,
 			                     ppd_coption_t *b);
 static int		ppd_compare_options(ppd_option_t *a, ppd_option_t *b);
+static int		ppd_compare_translations(ppd_attr_t *a,
+			                         ppd_attr_t *b);
 static void		ppd_free_filters(ppd_file_t *ppd);
 static void		ppd_free_group(ppd_group_t *group);
 static void		ppd_free_option(ppd_option_t *option);
@@ -97,6 +99,11 @@ static void		ppd_globals_free(ppd_globals_t *g);
 static void		ppd_globals_init(void);
 #endif // HAVE_PTHREAD_H
 static int		ppd_hash_option(ppd_option_t *option);
+static int		ppd_hash_translation(ppd_attr_t *attr);
+static int		ppd_is_localized(const char *name);
+static ppd_file_t	*ppd_open(cups_file_t *fp,
+			          ppd_localization_t localization,
+				  const char *locale);
 static int		ppd_read(cups_file_t *fp, _ppd_line_t *line,
 			         char *keyword, char *option, char *text,
 				 char **string, int ignoreblank,
@@ -212,6 +219,11 @@ ppdClose(ppd_file_t *ppd)		// I - PPD file record
   }
 
   cupsArrayDelete(ppd->sorted_attrs);
+  cupsArrayDelete(ppd->translations);
+  cupsArrayDelete(ppd->localized_text);
+  free(ppd->emit_plan);
+  ippDelete(ppd->ipp_attrs);
+  cupsArrayDelete(ppd->ipp_attrs_marked);
 
   //
   // Free custom options...
@@ -274,6 +286,25 @@ ppdClose(ppd_file_t *ppd)		// I - PPD file record
   if (ppd->cache)
     ppdCacheDestroy(ppd->cache);
 
+  //
+  // Free any compiled raster setup code and page headers...
+  //
+
+  cupsArrayDelete(ppd->raster_code);
+
+  if (ppd->raster_headers)
+  {
+    void *header;			// Current page header
+
+
+    for (header = cupsArrayGetFirst(ppd->raster_headers);
+         header;
+	 header = cupsArrayGetNext(ppd->raster_headers))
+      free(header);
+
+    cupsArrayDelete(ppd->raster_headers);
+  }
+
   //
   // Free the whole record...
   //
@@ -414,6 +445,28 @@ ppdLastError(int *line)			// O - Line number
 }
 
 
+//
+// 'ppdOpenWithLocale()' - Read a PPD file into memory, keeping only the
+//                         localizations for the given locale.
+//
+// Localized attributes are only kept for the locale and the locales
+// @link ppdLocalizedAttr@ falls back to for it, like
+// @code PPD_LOCALIZATION_DEFAULT@ does for the current locale.  This keeps
+// the memory use low when the PPD file is used for a locale which is not
+// the one of the current process.
+//
+// @since libppd 2.2.0@
+//
+
+ppd_file_t *				// O - PPD file record or @code NULL@ if the PPD file could not be opened.
+ppdOpenWithLocale(cups_file_t *fp,	// I - File to read from
+                  const char  *locale)	// I - Locale ("ll" or "ll_CC") or
+					//     @code NULL@ for the current one
+{
+  return (ppd_open(fp, PPD_LOCALIZATION_DEFAULT, locale));
+}
+
+
 //
 // 'ppdOpenWithLocalization()' - Read a PPD file into memory.
 //
@@ -424,6 +477,22 @@ ppd_file_t *				// O - PPD file record or @code NULL@ if the PPD file could not
 ppdOpenWithLocalization(
     cups_file_t		*fp,		// I - File to read from
     ppd_localization_t	localization)	// I - Localization to load
+{
+  return (ppd_open(fp, localization, NULL));
+}
+
+
+//
+// 'ppd_open()' - Read a PPD file into memory.
+//
+
+static ppd_file_t *			// O - PPD file record or @code NULL@
+ppd_open(
+    cups_file_t		*fp,		// I - File to read from
+    ppd_localization_t	localization,	// I - Localization to load
+    const char		*locale)	// I - Locale for
+					//     @code PPD_LOCALIZATION_DEFAULT@ or
+					//     @code NULL@ for the current one
 {
   int			i, j, k;	// Looping vars
   _ppd_line_t		line;		// Line buffer
@@ -532,7 +601,8 @@ ppdOpenWithLocalization(
 			};
 
 
-  DEBUG_printf(("ppdOpenWithLocalization(fp=%p)", fp));
+  DEBUG_printf(("ppd_open(fp=%p, localization=%d, locale=\"%s\")", fp,
+                localization, locale));
 
   //
   // Default to "OK" status...
@@ -557,10 +627,15 @@ ppdOpenWithLocalization(
 
   if (localization == PPD_LOCALIZATION_DEFAULT)
   {
-    if ((lang = cupsLangDefault()) == NULL)
-      return (NULL);
+    if (!locale)
+    {
+      if ((lang = cupsLangDefault()) == NULL)
+	return (NULL);
+
+      locale = cupsLangGetName(lang);
+    }
 
-    snprintf(ll_CC, sizeof(ll_CC), "%.5s.", cupsLangGetName(lang));
+    snprintf(ll_CC, sizeof(ll_CC), "%.5s.", locale);
 
     //
     // <rdar://problem/22130168>
@@ -569,31 +644,31 @@ ppdOpenWithLocalization(
     // Need to use a different base language for some locales...
     //
 
-    if (!strcmp(cupsLangGetName(lang), "zh_HK"))
+    if (!strcmp(locale, "zh_HK"))
     {					// Traditional Chinese + variants
       strlcpy(ll_CC, "zh_TW.", sizeof(ll_CC));
       strlcpy(ll, "zh_", sizeof(ll));
     }
-    else if (!strncmp(cupsLangGetName(lang), "zh", 2))
+    else if (!strncmp(locale, "zh", 2))
       strlcpy(ll, "zh_", sizeof(ll));	// Any Chinese variant
-    else if (!strncmp(cupsLangGetName(lang), "jp", 2))
-    {					// Any Japanese variant
+    else if (!strncmp(locale, "ja", 2) || !strncmp(locale, "jp", 2))
+    {					// Any Japanese variant, including
+					// the "jp" of old ppdmerge versions
       strlcpy(ll_CC, "ja", sizeof(ll_CC));
       strlcpy(ll, "jp", sizeof(ll));
     }
-    else if (!strncmp(cupsLangGetName(lang), "nb", 2) ||
-	     !strncmp(cupsLangGetName(lang), "no", 2))
+    else if (!strncmp(locale, "nb", 2) || !strncmp(locale, "no", 2))
     {					// Any Norwegian variant
       strlcpy(ll_CC, "nb", sizeof(ll_CC));
       strlcpy(ll, "no", sizeof(ll));
     }
     else
-      snprintf(ll, sizeof(ll), "%2.2s.", cupsLangGetName(lang));
+      snprintf(ll, sizeof(ll), "%2.2s.", locale);
 
     ll_CC_len = strlen(ll_CC);
     ll_len    = strlen(ll);
 
-    DEBUG_printf(("2ppdOpenWithLocalization: Loading localizations matching \"%s\" and \"%s\"",
+    DEBUG_printf(("2ppd_open: Loading localizations matching \"%s\" and \"%s\"",
                   ll_CC, ll));
   }
 
@@ -606,7 +681,7 @@ ppdOpenWithLocalization(
 
   mask = ppd_read(fp, &line, keyword, name, text, &string, 0, pg);
 
-  DEBUG_printf(("2ppdOpenWithLocalization: mask=%x, keyword=\"%s\"...",
+  DEBUG_printf(("2ppd_open: mask=%x, keyword=\"%s\"...",
 		mask, keyword));
 
   if (mask == 0 ||
@@ -626,7 +701,7 @@ ppdOpenWithLocalization(
     return (NULL);
   }
 
-  DEBUG_printf(("2ppdOpenWithLocalization: keyword=%s, string=%p",
+  DEBUG_printf(("2ppd_open: keyword=%s, string=%p",
 		keyword, string));
 
   //
@@ -667,7 +742,7 @@ ppdOpenWithLocalization(
 
   while ((mask = ppd_read(fp, &line, keyword, name, text, &string, 1, pg)) != 0)
   {
-    DEBUG_printf(("2ppdOpenWithLocalization: mask=%x, keyword=\"%s\", name=\"%s\", "
+    DEBUG_printf(("2ppd_open: mask=%x, keyword=\"%s\", name=\"%s\", "
                   "text=\"%s\", string=%d chars...", mask, keyword, name, text,
 		  string ? (int)strlen(string) : 0));
 
@@ -723,7 +798,7 @@ ppdOpenWithLocalization(
 	   strncmp(ll_CC, keyword, ll_CC_len) &&
 	   strncmp(ll, keyword, ll_len)))
       {
-	DEBUG_printf(("2ppdOpenWithLocalization: Ignoring localization: \"%s\"\n",
+	DEBUG_printf(("2ppd_open: Ignoring localization: \"%s\"\n",
 		      keyword));
 	free(string);
 	string = NULL;
@@ -745,7 +820,7 @@ ppdOpenWithLocalization(
 
 	if (i >= (int)(sizeof(color_keywords) / sizeof(color_keywords[0])))
 	{
-	  DEBUG_printf(("2ppdOpenWithLocalization: Ignoring localization: \"%s\"\n", keyword));
+	  DEBUG_printf(("2ppd_open: Ignoring localization: \"%s\"\n", keyword));
 	  free(string);
 	  string = NULL;
 	  continue;
@@ -769,7 +844,7 @@ ppdOpenWithLocalization(
 
         ui_keyword = 1;
 
-        DEBUG_printf(("2ppdOpenWithLocalization: FOUND ADOBE UI KEYWORD %s WITHOUT OPENUI!",
+        DEBUG_printf(("2ppd_open: FOUND ADOBE UI KEYWORD %s WITHOUT OPENUI!",
 	              keyword));
 
         if (!group)
@@ -778,7 +853,7 @@ ppdOpenWithLocalization(
 	                             encoding)) == NULL)
 	    goto error;
 
-          DEBUG_printf(("2ppdOpenWithLocalization: Adding to group %s...",
+          DEBUG_printf(("2ppd_open: Adding to group %s...",
 			group->text));
           option = ppd_get_option(group, keyword);
 	  group  = NULL;
@@ -814,7 +889,7 @@ ppdOpenWithLocalization(
 	      !strcmp(ppd->attrs[j]->name + 7, keyword) &&
 	      ppd->attrs[j]->value)
 	  {
-	    DEBUG_printf(("2ppdOpenWithLocalization: Setting Default%s to %s via attribute...",
+	    DEBUG_printf(("2ppd_open: Setting Default%s to %s via attribute...",
 	                  option->keyword, ppd->attrs[j]->value));
 	    strlcpy(option->defchoice, ppd->attrs[j]->value,
 	            sizeof(option->defchoice));
@@ -1131,7 +1206,7 @@ ppdOpenWithLocalization(
     {
       ppd_option_t	*custom_option;	// Custom option
 
-      DEBUG_puts("2ppdOpenWithLocalization: Processing Custom option...");
+      DEBUG_puts("2ppd_open: Processing Custom option...");
 
       //
       // Get the option and custom option...
@@ -1158,7 +1233,7 @@ ppdOpenWithLocalization(
         if ((choice = ppdFindChoice(custom_option, "Custom")) == NULL)
 	  if ((choice = ppd_add_choice(custom_option, "Custom")) == NULL)
 	  {
-	    DEBUG_puts("1ppdOpenWithLocalization: Unable to add Custom choice!");
+	    DEBUG_puts("1ppd_open: Unable to add Custom choice!");
 
 	    pg->ppd_status = PPD_ALLOC_ERROR;
 
@@ -1198,7 +1273,7 @@ ppdOpenWithLocalization(
 	  if ((choice = ppdFindChoice(custom_option, "Custom")) == NULL)
 	    if ((choice = ppd_add_choice(custom_option, "Custom")) == NULL)
 	    {
-	      DEBUG_puts("1ppdOpenWithLocalization: Unable to add Custom choice!");
+	      DEBUG_puts("1ppd_open: Unable to add Custom choice!");
 
 	      pg->ppd_status = PPD_ALLOC_ERROR;
 
@@ -1305,7 +1380,7 @@ ppdOpenWithLocalization(
       // Add an option record to the current sub-group, group, or file...
       //
 
-      DEBUG_printf(("2ppdOpenWithLocalization: name=\"%s\" (%d)",
+      DEBUG_printf(("2ppd_open: name=\"%s\" (%d)",
 		    name, (int)strlen(name)));
 
       if (name[0] == '*')
@@ -1314,7 +1389,7 @@ ppdOpenWithLocalization(
       for (i = (int)strlen(name) - 1; i > 0 && _ppd_isspace(name[i]); i --)
         name[i] = '\0'; // Eliminate trailing spaces
 
-      DEBUG_printf(("2ppdOpenWithLocalization: OpenUI of %s in group %s...",
+      DEBUG_printf(("2ppd_open: OpenUI of %s in group %s...",
 		    name, group ? group->text : "(null)"));
 
       if (subgroup != NULL)
@@ -1325,7 +1400,7 @@ ppdOpenWithLocalization(
 	                           encoding)) == NULL)
 	  goto error;
 
-        DEBUG_printf(("2ppdOpenWithLocalization: Adding to group %s...",
+        DEBUG_printf(("2ppd_open: Adding to group %s...",
 		      group->text));
         option = ppd_get_option(group, name);
 	group  = NULL;
@@ -1364,7 +1439,7 @@ ppdOpenWithLocalization(
 	    !strcmp(ppd->attrs[j]->name + 7, name) &&
 	    ppd->attrs[j]->value)
 	{
-	  DEBUG_printf(("2ppdOpenWithLocalization: Setting Default%s to %s via attribute...",
+	  DEBUG_printf(("2ppd_open: Setting Default%s to %s via attribute...",
 	                option->keyword, ppd->attrs[j]->value));
 	  strlcpy(option->defchoice, ppd->attrs[j]->value,
 	          sizeof(option->defchoice));
@@ -1410,7 +1485,7 @@ ppdOpenWithLocalization(
         if ((choice = ppdFindChoice(option, "Custom")) == NULL)
 	  if ((choice = ppd_add_choice(option, "Custom")) == NULL)
 	  {
-	    DEBUG_puts("1ppdOpenWithLocalization: Unable to add Custom choice!");
+	    DEBUG_puts("1ppd_open: Unable to add Custom choice!");
 
 	    pg->ppd_status = PPD_ALLOC_ERROR;
 
@@ -1483,7 +1558,7 @@ ppdOpenWithLocalization(
 	    !strcmp(ppd->attrs[j]->name + 7, name) &&
 	    ppd->attrs[j]->value)
 	{
-	  DEBUG_printf(("2ppdOpenWithLocalization: Setting Default%s to %s via attribute...",
+	  DEBUG_printf(("2ppd_open: Setting Default%s to %s via attribute...",
 	                option->keyword, ppd->attrs[j]->value));
 	  strlcpy(option->defchoice, ppd->attrs[j]->value,
 	          sizeof(option->defchoice));
@@ -1513,7 +1588,7 @@ ppdOpenWithLocalization(
       {
 	if ((choice = ppd_add_choice(option, "Custom")) == NULL)
 	{
-	  DEBUG_puts("1ppdOpenWithLocalization: Unable to add Custom choice!");
+	  DEBUG_puts("1ppd_open: Unable to add Custom choice!");
 
 	  pg->ppd_status = PPD_ALLOC_ERROR;
 
@@ -1554,7 +1629,7 @@ ppdOpenWithLocalization(
 	{
 	  strlcpy(option->defchoice, tchoice, sizeof(option->defchoice));
 
-	  DEBUG_printf(("2ppdOpenWithLocalization: Reset Default%s to %s...",
+	  DEBUG_printf(("2ppd_open: Reset Default%s to %s...",
 			option->keyword, tchoice));
 	}
       }
@@ -1592,7 +1667,7 @@ ppdOpenWithLocalization(
 	{
 	  strlcpy(option->defchoice, tchoice, sizeof(option->defchoice));
 
-	  DEBUG_printf(("2ppdOpenWithLocalization: Reset Default%s to %s...",
+	  DEBUG_printf(("2ppd_open: Reset Default%s to %s...",
 			option->keyword, tchoice));
 	}
       }
@@ -1757,7 +1832,7 @@ ppdOpenWithLocalization(
 
         strlcpy(option->defchoice, string, sizeof(option->defchoice));
 
-	DEBUG_printf(("2ppdOpenWithLocalization: Set %s to %s...",
+	DEBUG_printf(("2ppd_open: Set %s to %s...",
 		      keyword, option->defchoice));
       }
       else
@@ -1771,7 +1846,7 @@ ppdOpenWithLocalization(
 
         if ((toption = ppdFindOption(ppd, keyword + 7)) != NULL)
 	{
-	  DEBUG_printf(("2ppdOpenWithLocalization: Setting %s to %s...",
+	  DEBUG_printf(("2ppd_open: Setting %s to %s...",
 			keyword, string));
 	  strlcpy(toption->defchoice, string, sizeof(toption->defchoice));
 	  if (!_ppd_strcasecmp(string, "custom") ||
@@ -1794,7 +1869,7 @@ ppdOpenWithLocalization(
 	    strlcpy(toption->defchoice, string, sizeof(toption->defchoice));
 	  }
 
-	  DEBUG_printf(("2ppdOpenWithLocalization: Set %s to %s...",
+	  DEBUG_printf(("2ppd_open: Set %s to %s...",
 			keyword, toption->defchoice));
 	}
       }
@@ -2045,7 +2120,7 @@ ppdOpenWithLocalization(
 	         (PPD_KEYWORD | PPD_OPTION | PPD_STRING) &&
 	     !strcmp(keyword, option->keyword))
     {
-      DEBUG_printf(("2ppdOpenWithLocalization: group=%p, subgroup=%p", group, subgroup));
+      DEBUG_printf(("2ppd_open: group=%p, subgroup=%p", group, subgroup));
 
       if (!_ppd_strcasecmp(name, "custom") || !_ppd_strncasecmp(name, "custom.", 7))
       {
@@ -2131,7 +2206,7 @@ ppdOpenWithLocalization(
 
 #ifdef DEBUG
   if (!cupsFileEOF(fp))
-    DEBUG_printf(("1ppdOpenWithLocalization: Premature EOF at %lu...\n",
+    DEBUG_printf(("1ppd_open: Premature EOF at %lu...\n",
                   (unsigned long)cupsFileTell(fp)));
 #endif // DEBUG
 
@@ -2367,6 +2442,63 @@ ppdOpenFileWithLocalization(
 }
 
 
+//
+// 'ppdOpenFileWithLocale()' - Read a PPD file into memory, keeping only the
+//                             localizations for the given locale.
+//
+// @since libppd 2.2.0@
+//
+
+ppd_file_t *				// O - PPD file record or @code NULL@
+					//     if the PPD file could not be
+					//     opened.
+ppdOpenFileWithLocale(
+    const char		*filename,	// I - File to read from
+    const char		*locale)	// I - Locale ("ll" or "ll_CC") or
+					//     @code NULL@ for the current one
+{
+  cups_file_t		*fp;		// File pointer
+  ppd_file_t		*ppd;		// PPD file record
+  ppd_globals_t	*pg = ppdGlobals();	// Global data
+
+
+  //
+  // Set the line number to 0...
+  //
+
+  pg->ppd_line = 0;
+
+  //
+  // Range check input...
+  //
+
+  if (filename == NULL)
+  {
+    pg->ppd_status = PPD_NULL_FILE;
+
+    return (NULL);
+  }
+
+  //
+  // Try to open the file and parse it...
+  //
+
+  if ((fp = cupsFileOpen(filename, "r")) != NULL)
+  {
+    ppd = ppdOpenWithLocale(fp, locale);
+
+    cupsFileClose(fp);
+  }
+  else
+  {
+    pg->ppd_status = PPD_FILE_OPEN_ERROR;
+    ppd            = NULL;
+  }
+
+  return (ppd);
+}
+
+
 //
 // 'ppdOpenFile()' - Read a PPD file into memory.
 //
@@ -2471,6 +2603,24 @@ ppd_add_attr(ppd_file_t *ppd,		// I - PPD file data
 
   cupsArrayAdd(ppd->sorted_attrs, temp);
 
+  //
+  // Add localized attributes ("*ll_CC.Keyword spec") to the translation
+  // table, keeping only the first one for each name and spec like
+  // ppdFindAttr() does...
+  //
+
+  if (ppd_is_localized(temp->name))
+  {
+    if (!ppd->translations)
+      ppd->translations =
+          cupsArrayNew((cups_array_cb_t)ppd_compare_translations, NULL,
+	               (cups_ahash_cb_t)ppd_hash_translation, PPD_HASHSIZE,
+		       NULL, NULL);
+
+    if (!cupsArrayFind(ppd->translations, temp))
+      cupsArrayAdd(ppd->translations, temp);
+  }
+
   //
   // Return the attribute...
   //
@@ -2589,6 +2739,24 @@ ppd_compare_options(ppd_option_t *a,	// I - First option
 }
 
 
+//
+// 'ppd_compare_translations()' - Compare two localized attributes.
+//
+
+static int				// O - Result of comparison
+ppd_compare_translations(ppd_attr_t *a,	// I - First attribute
+                         ppd_attr_t *b)	// I - Second attribute
+{
+  int	diff;				// Difference
+
+
+  if ((diff = _ppd_strcasecmp(a->name, b->name)) != 0)
+    return (diff);
+  else
+    return (_ppd_strcasecmp(a->spec, b->spec));
+}
+
+
 //
 // 'ppdDecode()' - Decode a string value with hex-encoded characters
 //
@@ -2975,6 +3143,51 @@ ppd_hash_option(ppd_option_t *option)	// I - Option
 }
 
 
+//
+// 'ppd_hash_translation()' - Generate a hash of a localized attribute's
+//                            name and specifier...
+//
+
+static int				// O - Hash index
+ppd_hash_translation(ppd_attr_t *attr)	// I - Attribute
+{
+  unsigned	hash = 0;		// Hash index
+  const char	*k;			// Pointer into name/spec
+
+
+  for (k = attr->name; *k; k ++)
+    hash = 33U * hash + (unsigned)_ppd_tolower(*k);
+
+  for (k = attr->spec; *k; k ++)
+    hash = 33U * hash + (unsigned)_ppd_tolower(*k);
+
+  return ((int)(hash & (PPD_HASHSIZE - 1)));
+}
+
+
+//
+// 'ppd_is_localized()' - Check whether an attribute name has a locale
+//                        prefix ("ll." or "ll_CC.").
+//
+
+static int				// O - 1 if localized, 0 otherwise
+ppd_is_localized(const char *name)	// I - Attribute name
+{
+  if (!_ppd_isalpha(name[0]) || !_ppd_isalpha(name[1]))
+    return (0);
+
+  if (name[2] == '_')
+  {
+    if (!_ppd_isalpha(name[3]) || !_ppd_isalpha(name[4]))
+      return (0);
+
+    name += 3;
+  }
+
+  return (name[2] == '.' && name[3]);
+}
+
+
 //
 // 'ppd_read()' - Read a line from a PPD file, skipping comment lines as
 //                necessary.
@@ -562,6 +562,22 @@ typedef struct ppd_file_s		// **** PPD File ****
   // **** New in CUPS 1.5 ****
   ppd_cache_t	*cache;			// PPD cache and mapping data @since
 					// CUPS 1.5/macOS 10.7@ @private@
+
+  // **** New in libppd 2.2.0 ****
+  cups_array_t	*raster_code;		// Compiled code of choices for
+					// ppdRasterInterpretPPD() @private@
+  cups_array_t	*raster_headers;	// Recently computed page headers of
+					// ppdRasterInterpretPPD() @private@
+  cups_array_t	*translations;		// Localized attributes hashed by name
+					// and spec @private@
+  cups_array_t	*localized_text;	// Texts looked up by
+					// ppdLocalizeText() @private@
+  struct _ppd_emit_plan_s *emit_plan;	// Options sorted for
+					// ppdCollect2() @private@
+  ipp_t		*ipp_attrs;		// Last result of
+					// ppdLoadAttributes() @private@
+  cups_array_t	*ipp_attrs_marked;	// Marked choices for ipp_attrs
+					// @private@
 } ppd_file_t;
 
 // **** New in libppd 2.0.0: Overtaken from cups-driverd ****
@@ -874,6 +890,13 @@ char            *ppdCreatePPDFromIPP2(char *buffer, size_t bufsize,
 				      char* default_pagesize,
 				      const char *default_cluster_color,
 				      char *status_msg, size_t status_msg_size);
+// **** New in libppd 2.2.0: Generate PPDs for many printers at once ****
+int		ppdCreatePPDsFromIPP(int num_printers, ipp_t **supported,
+				     const char **make_models,
+				     const char **pdls, const int *colors,
+				     const int *duplexes, char **buffers,
+				     size_t bufsize, char **status_msgs,
+				     size_t status_msg_size);
 
 // **** New in libppd 2.0.0: Functions to load color profile data from
 //      PPD files, from driver.h ****
@@ -911,6 +934,24 @@ extern int ppdTest(int ignore, int warn, char *rootdir,
 		   cups_array_t *file_array, cups_array_t **report,
 		   cf_logfunc_t log, void *ld);
 
+// **** New in libppd 2.2.0: Test many PPD files with several
+//      processes ****
+extern int ppdTestFiles(int ignore, int warn, char *rootdir,
+			int verbose, int relaxed, int root_present,
+			cups_array_t *file_array, int jobs,
+			cups_array_t **report, cf_logfunc_t log, void *ld);
+
+// **** New in libppd 2.2.0: Load only the localizations of a given
+//      locale ****
+extern ppd_file_t	*ppdOpenWithLocale(cups_file_t *fp,
+					   const char *locale);
+extern ppd_file_t	*ppdOpenFileWithLocale(const char *filename,
+					       const char *locale);
+
+// **** New in libppd 2.2.0: Localize texts on demand ****
+extern const char	*ppdLocalizeText(ppd_file_t *ppd, const char *keyword,
+					 const char *choice);
+
 
 //
 // C++ magic...
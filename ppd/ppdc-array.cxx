@@ -81,7 +81,8 @@ ppdcArray::add(ppdcShared *d)
 
   if (count >= alloc)
   {
-    alloc += 10;
+    // Double the size of the array so that adding is amortized O(1)...
+    alloc = alloc ? 2 * alloc : 10;
     temp  = new ppdcShared *[alloc];
 
     memcpy(temp, data, (size_t)count * sizeof(ppdcShared *));
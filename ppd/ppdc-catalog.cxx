@@ -13,6 +13,8 @@
 //
 
 #include "ppdc-private.h"
+#include "libcups2-private.h"
+#include "string-private.h"
 
 
 //
@@ -28,12 +30,32 @@ typedef enum
 } ppdc_cs_t;
 
 
+//
+// Constants...
+//
+
+#define PPDC_MESSAGE_HASHSIZE	4096	// Size of message hash table
+
+
+//
+// Types...
+//
+
+typedef struct ppdc_msgref_s		// Message index entry
+{
+  const char	*id;			// Message ID
+  ppdcMessage	*message;		// Message
+} ppdc_msgref_t;
+
+
 //
 // Local functions...
 //
 
+static int	compare_msgrefs(ppdc_msgref_t *a, ppdc_msgref_t *b);
 static int	get_utf8(char *&ptr);
 static int	get_utf16(cups_file_t *fp, ppdc_cs_t &cs);
+static int	hash_msgref(ppdc_msgref_t *r, void *data);
 static int	put_utf8(int ch, char *&ptr, char *end);
 static int	put_utf16(cups_file_t *fp, int ch);
 
@@ -51,6 +73,9 @@ ppdcCatalog::ppdcCatalog(const char *l,	// I - Locale
   locale   = new ppdcString(l);
   filename = new ppdcString(f);
   messages = new ppdcArray();
+  index    = cupsArrayNew((cups_array_cb_t)compare_msgrefs, NULL,
+                          (cups_ahash_cb_t)hash_msgref, PPDC_MESSAGE_HASHSIZE,
+			  NULL, (cups_afree_cb_t)free);
 
   if (l && strcmp(l, "en"))
   {
@@ -93,6 +118,7 @@ ppdcCatalog::~ppdcCatalog()
   locale->release();
   filename->release();
   messages->release();
+  cupsArrayDelete(index);
 }
 
 
@@ -106,6 +132,8 @@ ppdcCatalog::add_message(
     const char *string)			// I - Translation string
 {
   ppdcMessage	*m;			// Current message
+  ppdc_msgref_t	key,			// Search key
+		*r;			// Message index entry
   char		text[1024];		// Text to translate
 
 
@@ -114,18 +142,18 @@ ppdcCatalog::add_message(
     return;
 
   // Verify that we don't already have the message ID...
-  for (m = (ppdcMessage *)messages->first();
-       m;
-       m = (ppdcMessage *)messages->next())
-    if (!strcmp(m->id->value, id))
+  key.id = id;
+
+  if ((r = (ppdc_msgref_t *)cupsArrayFind(index, &key)) != NULL)
+  {
+    if (string)
     {
-      if (string)
-      {
-        m->string->release();
-	m->string = new ppdcString(string);
-      }
-      return;
+      m = r->message;
+      m->string->release();
+      m->string = new ppdcString(string);
     }
+    return;
+  }
 
   // Add the message...
   if (!string)
@@ -134,7 +162,16 @@ ppdcCatalog::add_message(
     string = text;
   }
 
-  messages->add(new ppdcMessage(id, string));
+  m = new ppdcMessage(id, string);
+  messages->add(m);
+
+  if ((r = (ppdc_msgref_t *)malloc(sizeof(ppdc_msgref_t))) != NULL)
+  {
+    r->id      = m->id->value;
+    r->message = m;
+
+    cupsArrayAdd(index, r);
+  }
 }
 
 
@@ -146,17 +183,17 @@ const char *				// O - Message text
 ppdcCatalog::find_message(
     const char *id)			// I - Message ID
 {
-  ppdcMessage	*m;			// Current message
+  ppdc_msgref_t	key,			// Search key
+		*r;			// Message index entry
 
 
   if (!*id)
     return (id);
 
-  for (m = (ppdcMessage *)messages->first();
-       m;
-       m = (ppdcMessage *)messages->next())
-    if (!strcmp(m->id->value, id))
-      return (m->string->value);
+  key.id = id;
+
+  if ((r = (ppdc_msgref_t *)cupsArrayFind(index, &key)) != NULL)
+    return (r->message->string->value);
 
   return (id);
 }
@@ -591,6 +628,18 @@ ppdcCatalog::save_messages(
 }
 
 
+//
+// 'compare_msgrefs()' - Compare the IDs of two messages.
+//
+
+static int				// O - Result of comparison
+compare_msgrefs(ppdc_msgref_t *a,	// I - First message
+                ppdc_msgref_t *b)	// I - Second message
+{
+  return (strcmp(a->id, b->id));
+}
+
+
 //
 // 'get_utf8()' - Get a UTF-8 character.
 //
@@ -783,6 +832,20 @@ get_utf16(cups_file_t *fp,		// I  - File to read from
 }
 
 
+//
+// 'hash_msgref()' - Compute the hash of a message ID.
+//
+
+static int				// O - Hash value
+hash_msgref(ppdc_msgref_t *r,		// I - Message
+            void          *data)	// I - Callback data (unused)
+{
+  (void)data;
+
+  return ((int)(_ppdHashString(r->id, 0) % PPDC_MESSAGE_HASHSIZE));
+}
+
+
 //
 // 'put_utf8()' - Add a UTF-8 character to a string.
 //
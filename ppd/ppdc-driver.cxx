@@ -16,6 +16,13 @@
 #include "string-private.h"
 
 
+//
+// Local functions...
+//
+
+static ppdcArray	*unshare_array(ppdcArray *a);
+
+
 //
 // 'ppdcDriver::ppdcDriver()' - Create a new printer driver.
 //
@@ -23,11 +30,12 @@
 ppdcDriver::ppdcDriver(ppdcDriver *d)	// I - Printer driver template
   : ppdcShared()
 {
-  ppdcGroup	*g;			// Current group
-
-
   PPDC_NEW;
 
+  // The name indexes are created when they are first needed...
+  attr_index  = NULL;
+  group_index = NULL;
+
   if (d)
   {
     // Bump the use count of any strings we inherit...
@@ -42,8 +50,20 @@ ppdcDriver::ppdcDriver(ppdcDriver *d)	// I - Printer driver template
     if (d->custom_size_code)
       d->custom_size_code->retain();
 
+    // Share the arrays of the driver template; the add_*() methods and
+    // unshare_groups() copy an array before it is changed, so most drivers
+    // that just set a model name only keep references to the template...
+    d->copyright->retain();
+    d->attrs->retain();
+    d->constraints->retain();
+    d->filters->retain();
+    d->fonts->retain();
+    d->groups->retain();
+    d->profiles->retain();
+    d->sizes->retain();
+
     // Copy all of the data from the driver template...
-    copyright           = new ppdcArray(d->copyright);
+    copyright           = d->copyright;
     manufacturer        = d->manufacturer;
     model_name          = 0;
     file_name           = 0;
@@ -54,12 +74,13 @@ ppdcDriver::ppdcDriver(ppdcDriver *d)	// I - Printer driver template
     manual_copies       = d->manual_copies;
     color_device        = d->color_device;
     throughput          = d->throughput;
-    attrs               = new ppdcArray(d->attrs);
-    constraints         = new ppdcArray(d->constraints);
-    filters             = new ppdcArray(d->filters);
-    fonts               = new ppdcArray(d->fonts);
-    profiles            = new ppdcArray(d->profiles);
-    sizes               = new ppdcArray(d->sizes);
+    attrs               = d->attrs;
+    constraints         = d->constraints;
+    filters             = d->filters;
+    fonts               = d->fonts;
+    groups              = d->groups;
+    profiles            = d->profiles;
+    sizes               = d->sizes;
     default_font        = d->default_font;
     default_size        = d->default_size;
     variable_paper_size = d->variable_paper_size;
@@ -72,13 +93,6 @@ ppdcDriver::ppdcDriver(ppdcDriver *d)	// I - Printer driver template
     max_length          = d->max_length;
     min_width           = d->min_width;
     min_length          = d->min_length;
-
-    // Then copy the groups manually, since we want separate copies
-    // of the groups and options...
-    groups = new ppdcArray();
-
-    for (g = (ppdcGroup *)d->groups->first(); g; g = (ppdcGroup *)d->groups->next())
-      groups->add(new ppdcGroup(g));
   }
   else
   {
@@ -151,6 +165,111 @@ ppdcDriver::~ppdcDriver()
   groups->release();
   profiles->release();
   sizes->release();
+  cupsArrayDelete(attr_index);
+  cupsArrayDelete(group_index);
+}
+
+
+//
+// 'ppdcDriver::add_attr()' - Add an attribute.
+//
+
+void
+ppdcDriver::add_attr(ppdcAttr *a)	// I - Attribute
+{
+  attrs = unshare_array(attrs);
+  attrs->add(a);
+
+  if (attr_index)
+    _ppdcIndexAdd(attr_index, a->name->value, a);
+}
+
+
+//
+// 'ppdcDriver::add_constraint()' - Add a constraint.
+//
+
+void
+ppdcDriver::add_constraint(
+    ppdcConstraint *c)			// I - Constraint
+{
+  constraints = unshare_array(constraints);
+  constraints->add(c);
+}
+
+
+//
+// 'ppdcDriver::add_copyright()' - Add a copyright string.
+//
+
+void
+ppdcDriver::add_copyright(const char *c)// I - Copyright string
+{
+  copyright = unshare_array(copyright);
+  copyright->add(new ppdcString(c));
+}
+
+
+//
+// 'ppdcDriver::add_filter()' - Add a filter.
+//
+
+void
+ppdcDriver::add_filter(ppdcFilter *f)	// I - Filter
+{
+  filters = unshare_array(filters);
+  filters->add(f);
+}
+
+
+//
+// 'ppdcDriver::add_font()' - Add a font.
+//
+
+void
+ppdcDriver::add_font(ppdcFont *f)	// I - Font
+{
+  fonts = unshare_array(fonts);
+  fonts->add(f);
+}
+
+
+//
+// 'ppdcDriver::add_group()' - Add a group.
+//
+
+void
+ppdcDriver::add_group(ppdcGroup *g)	// I - Group
+{
+  unshare_groups();
+  groups->add(g);
+
+  if (group_index)
+    _ppdcIndexAdd(group_index, g->name->value, g);
+}
+
+
+//
+// 'ppdcDriver::add_profile()' - Add a color profile.
+//
+
+void
+ppdcDriver::add_profile(ppdcProfile *p)	// I - Color profile
+{
+  profiles = unshare_array(profiles);
+  profiles->add(p);
+}
+
+
+//
+// 'ppdcDriver::add_size()' - Add a media size.
+//
+
+void
+ppdcDriver::add_size(ppdcMediaSize *m)	// I - Media size
+{
+  sizes = unshare_array(sizes);
+  sizes->add(m);
 }
 
 
@@ -165,7 +284,24 @@ ppdcDriver::find_attr(const char *k,	// I - Keyword string
   ppdcAttr	*a;			// Current attribute
 
 
-  for (a = (ppdcAttr *)attrs->first(); a; a = (ppdcAttr *)attrs->next())
+  if (!attr_index)
+  {
+    // Index the attributes without disturbing the current element of the
+    // array, since callers may be looping over it...
+    attr_index = _ppdcIndexNew();
+
+    for (size_t i = 0; i < attrs->count; i ++)
+    {
+      a = (ppdcAttr *)attrs->data[i];
+      _ppdcIndexAdd(attr_index, a->name->value, a);
+    }
+  }
+
+  // The index ignores case, so check the exact name along with the
+  // selector...
+  for (a = (ppdcAttr *)_ppdcIndexFind(attr_index, k);
+       a;
+       a = (ppdcAttr *)_ppdcIndexNext(attr_index, k))
     if (!strcmp(a->name->value, k) &&
         ((!s && (!a->selector->value || !a->selector->value[0])) ||
 	 (s && a->selector->value && !strcmp(a->selector->value, s))))
@@ -185,11 +321,18 @@ ppdcDriver::find_group(const char *n)	// I - Group name
   ppdcGroup	*g;			// Current group
 
 
-  for (g = (ppdcGroup *)groups->first(); g; g = (ppdcGroup *)groups->next())
-    if (!strcasecmp(n, g->name->value))
-      return (g);
+  if (!group_index)
+  {
+    group_index = _ppdcIndexNew();
 
-  return (0);
+    for (size_t i = 0; i < groups->count; i ++)
+    {
+      g = (ppdcGroup *)groups->data[i];
+      _ppdcIndexAdd(group_index, g->name->value, g);
+    }
+  }
+
+  return ((ppdcGroup *)_ppdcIndexFind(group_index, n));
 }
 
 
@@ -218,14 +361,13 @@ ppdcDriver::find_option_group(
 
 
   for (g = (ppdcGroup *)groups->first(); g; g = (ppdcGroup *)groups->next())
-    for (o = (ppdcOption *)g->options->first(); o; o = (ppdcOption *)g->options->next())
-      if (!strcasecmp(n, o->name->value))
-      {
-        if (mg)
-	  *mg = g;
+    if ((o = g->find_option(n)) != NULL)
+    {
+      if (mg)
+	*mg = g;
 
-        return (o);
-      }
+      return (o);
+    }
 
   if (mg)
     *mg = (ppdcGroup *)0;
@@ -234,6 +376,23 @@ ppdcDriver::find_option_group(
 }
 
 
+//
+// 'ppdcDriver::remove_attr()' - Remove an attribute.
+//
+
+void
+ppdcDriver::remove_attr(ppdcAttr *a)	// I - Attribute
+{
+  // Rebuild the index on the next lookup, since removals are rare and the
+  // index cannot remove a single object with a duplicate name...
+  cupsArrayDelete(attr_index);
+  attr_index = NULL;
+
+  attrs = unshare_array(attrs);
+  attrs->remove(a);
+}
+
+
 //
 // 'ppdcDriver::set_custom_size_code()' - Set the custom page size code.
 //
@@ -364,6 +523,38 @@ ppdcDriver::set_version(const char *v)	// I - Version
 }
 
 
+//
+// 'ppdcDriver::unshare_groups()' - Make a private copy of the option groups.
+//
+// Groups and options are changed through the pointers returned by
+// find_group() and find_option(), so callers must make sure the driver
+// has its own copy before looking up anything they will change.
+//
+
+void
+ppdcDriver::unshare_groups()
+{
+  ppdcArray	*temp;			// New groups
+
+
+  if (!groups->shared())
+    return;
+
+  // Copy the groups manually, since we want separate copies of the groups
+  // and options...
+  temp = new ppdcArray();
+
+  for (size_t i = 0; i < groups->count; i ++)
+    temp->add(new ppdcGroup((ppdcGroup *)groups->data[i]));
+
+  groups->release();
+  groups = temp;
+
+  cupsArrayDelete(group_index);
+  group_index = NULL;
+}
+
+
 //
 // 'ppdcDriver::write_ppd_file()' - Write a PPD file...
 //
@@ -1322,3 +1513,23 @@ ppdcDriver::write_ppd_file(
 
   return (0);
 }
+
+
+//
+// 'unshare_array()' - Copy an array that is shared with another driver.
+//
+
+static ppdcArray *			// O - Array to change
+unshare_array(ppdcArray *a)		// I - Array
+{
+  ppdcArray	*temp;			// Copy of array
+
+
+  if (!a->shared())
+    return (a);
+
+  temp = new ppdcArray(a);
+  a->release();
+
+  return (temp);
+}
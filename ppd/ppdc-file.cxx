@@ -33,6 +33,8 @@ ppdcFile::ppdcFile(const char  *f,		// I - File to open
   close_on_delete = !ffp;
   filename        = f;
   line            = 1;
+  bufptr          = buffer;
+  bufend          = buffer;
 
   if (!fp)
     fprintf(stderr, _("ppdc: Unable to open %s: %s\n"), f,
@@ -51,6 +53,26 @@ ppdcFile::~ppdcFile()
 }
 
 
+//
+// 'ppdcFile::fill()' - Read the next block from a file.
+//
+
+bool					// O - true on success, false on EOF
+ppdcFile::fill()
+{
+  ssize_t	bytes;				// Bytes read
+
+
+  if (!fp || (bytes = cupsFileRead(fp, buffer, sizeof(buffer))) <= 0)
+    return (false);
+
+  bufptr = buffer;
+  bufend = buffer + bytes;
+
+  return (true);
+}
+
+
 //
 // 'ppdcFile::get()' - Get a character from a file.
 //
@@ -61,12 +83,12 @@ ppdcFile::get()
   int	ch;					// Character from file
 
 
-  // Return EOF if there is no open file...
-  if (!fp)
+  // Return EOF if there is no open file or nothing left to read...
+  if (bufptr >= bufend && !fill())
     return (EOF);
 
   // Get the character...
-  ch = cupsFileGetChar(fp);
+  ch = *bufptr++ & 255;
 
   // Update the line number as needed...
   if (ch == '\n')
@@ -84,10 +106,10 @@ ppdcFile::get()
 int					// O - Next character in file
 ppdcFile::peek()
 {
-  // Return immediately if there is no open file...
-  if (!fp)
+  // Return immediately if there is no open file or nothing left to read...
+  if (bufptr >= bufend && !fill())
     return (EOF);
 
   // Otherwise return the next character without advancing...
-  return (cupsFilePeekChar(fp));
+  return (*bufptr & 255);
 }
@@ -24,9 +24,10 @@ ppdcGroup::ppdcGroup(const char *n,	// I - Name of group
 {
   PPDC_NEWVAL(n);
 
-  name    = new ppdcString(n);
-  text    = new ppdcString(t);
-  options = new ppdcArray();
+  name         = new ppdcString(n);
+  text         = new ppdcString(t);
+  options      = new ppdcArray();
+  option_index = _ppdcIndexNew();
 }
 
 
@@ -44,11 +45,13 @@ ppdcGroup::ppdcGroup(ppdcGroup *g)	// I - Group template
   name = g->name;
   text = g->text;
 
-  options = new ppdcArray();
+  options      = new ppdcArray();
+  option_index = _ppdcIndexNew();
+
   for (ppdcOption *o = (ppdcOption *)g->options->first();
        o;
        o = (ppdcOption *)g->options->next())
-    options->add(new ppdcOption(o));
+    add_option(new ppdcOption(o));
 }
 
 
@@ -63,12 +66,26 @@ ppdcGroup::~ppdcGroup()
   name->release();
   text->release();
   options->release();
+  cupsArrayDelete(option_index);
 
   name = text = 0;
   options = 0;
 }
 
 
+//
+// 'ppdcGroup::add_option()' - Add an option to a group.
+//
+
+void
+ppdcGroup::add_option(ppdcOption *o)	// I - Option
+{
+  options->add(o);
+
+  _ppdcIndexAdd(option_index, o->name->value, o);
+}
+
+
 //
 // 'ppdcGroup::find_option()' - Find an option in a group.
 //
@@ -76,12 +93,23 @@ ppdcGroup::~ppdcGroup()
 ppdcOption *
 ppdcGroup::find_option(const char *n)	// I - Name of option
 {
-  ppdcOption	*o;			// Current option
+  return ((ppdcOption *)_ppdcIndexFind(option_index, n));
+}
 
 
-  for (o = (ppdcOption *)options->first(); o; o = (ppdcOption *)options->next())
-    if (!strcasecmp(n, o->name->value))
-      return (o);
+//
+// 'ppdcGroup::remove_option()' - Remove an option from a group.
+//
 
-  return (0);
+void
+ppdcGroup::remove_option(ppdcOption *o)	// I - Option
+{
+  // Rebuild the index after removing the option, since removals are rare
+  // and the index cannot remove a single object with a duplicate name...
+  cupsArrayClear(option_index);
+
+  options->remove(o);
+
+  for (o = (ppdcOption *)options->first(); o; o = (ppdcOption *)options->next())
+    _ppdcIndexAdd(option_index, o->name->value, o);
 }
@@ -0,0 +1,157 @@
+//
+// Name index functions for the CUPS PPD Compiler in libppd.
+//
+// Copyright © 2026 by OpenPrinting.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "ppdc-private.h"
+#include "libcups2-private.h"
+#include "string-private.h"
+
+
+//
+// Constants...
+//
+
+#define PPDC_INDEX_HASHSIZE	256	// Size of name hash table
+
+
+//
+// Types...
+//
+
+typedef struct ppdc_nameref_s		// Name index entry
+{
+  const char	*name;			// Name
+  ppdcShared	*data;			// Named object
+} ppdc_nameref_t;
+
+
+//
+// Local functions...
+//
+
+static int	compare_namerefs(ppdc_nameref_t *a, ppdc_nameref_t *b);
+static int	hash_nameref(ppdc_nameref_t *r, void *data);
+
+
+//
+// '_ppdcIndexAdd()' - Add a named object to an index.
+//
+// Objects with the same name are kept in the order they are added.  The
+// name string must stay valid as long as the object is in the index.
+//
+
+void
+_ppdcIndexAdd(cups_array_t *a,		// I - Index
+              const char   *name,	// I - Name
+              ppdcShared   *data)	// I - Named object
+{
+  ppdc_nameref_t	*r;		// New index entry
+
+
+  if (!a || !name)
+    return;
+
+  if ((r = (ppdc_nameref_t *)malloc(sizeof(ppdc_nameref_t))) != NULL)
+  {
+    r->name = name;
+    r->data = data;
+
+    cupsArrayAdd(a, r);
+  }
+}
+
+
+//
+// '_ppdcIndexFind()' - Find the first object with a name, ignoring case.
+//
+
+ppdcShared *				// O - Object or NULL
+_ppdcIndexFind(cups_array_t *a,		// I - Index
+               const char   *name)	// I - Name
+{
+  ppdc_nameref_t	key,		// Search key
+			*r;		// Matching index entry
+
+
+  if (!a || !name)
+    return (NULL);
+
+  key.name = name;
+
+  if ((r = (ppdc_nameref_t *)cupsArrayFind(a, &key)) != NULL)
+    return (r->data);
+
+  return (NULL);
+}
+
+
+//
+// '_ppdcIndexNew()' - Create a case-insensitive name index.
+//
+
+cups_array_t *				// O - Index
+_ppdcIndexNew(void)
+{
+  return (cupsArrayNew((cups_array_cb_t)compare_namerefs, NULL,
+                       (cups_ahash_cb_t)hash_nameref, PPDC_INDEX_HASHSIZE,
+		       NULL, (cups_afree_cb_t)free));
+}
+
+
+//
+// '_ppdcIndexNext()' - Find the next object with the same name.
+//
+// This continues a search started with _ppdcIndexFind().
+//
+
+ppdcShared *				// O - Object or NULL
+_ppdcIndexNext(cups_array_t *a,		// I - Index
+               const char   *name)	// I - Name
+{
+  ppdc_nameref_t	*r;		// Next index entry
+
+
+  if (!a || !name)
+    return (NULL);
+
+  if ((r = (ppdc_nameref_t *)cupsArrayGetNext(a)) != NULL &&
+      !strcasecmp(r->name, name))
+    return (r->data);
+
+  return (NULL);
+}
+
+
+//
+// 'compare_namerefs()' - Compare two names without regard to case.
+//
+
+static int				// O - Result of comparison
+compare_namerefs(ppdc_nameref_t *a,	// I - First name
+                 ppdc_nameref_t *b)	// I - Second name
+{
+  return (strcasecmp(a->name, b->name));
+}
+
+
+//
+// 'hash_nameref()' - Compute the hash of a name without regard to case.
+//
+
+static int				// O - Hash value
+hash_nameref(ppdc_nameref_t *r,		// I - Name
+             void           *data)	// I - Callback data (unused)
+{
+  (void)data;
+
+  return ((int)(_ppdHashString(r->name, 1) % PPDC_INDEX_HASHSIZE));
+}
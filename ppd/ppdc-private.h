@@ -43,4 +43,15 @@
 
 #  define _(x) x
 
+
+//
+// Name index functions...
+//
+
+extern void		_ppdcIndexAdd(cups_array_t *a, const char *name,
+			              ppdcShared *data);
+extern ppdcShared	*_ppdcIndexFind(cups_array_t *a, const char *name);
+extern cups_array_t	*_ppdcIndexNew(void);
+extern ppdcShared	*_ppdcIndexNext(cups_array_t *a, const char *name);
+
 #endif // !_PPDC_PRIVATE_H_
@@ -42,6 +42,57 @@ const char	*ppdcSource::driver_types[] =
 		};
 
 
+//
+// Local globals...
+//
+
+static const char * const simple_directives[] =
+		{			// Directives that don't use groups
+		  "#define",
+		  "#elif",
+		  "#else",
+		  "#endif",
+		  "#font",
+		  "#if",
+		  "#include",
+		  "#media",
+		  "#po",
+		  "Attribute",
+		  "ColorDevice",
+		  "ColorProfile",
+		  "Copyright",
+		  "DriverType",
+		  "FileName",
+		  "Filter",
+		  "Font",
+		  "HWMargins",
+		  "LocAttribute",
+		  "ManualCopies",
+		  "Manufacturer",
+		  "MaxSize",
+		  "MediaSize",
+		  "MinSize",
+		  "ModelName",
+		  "ModelNumber",
+		  "PCFileName",
+		  "SimpleColorProfile",
+		  "Throughput",
+		  "UIConstraints",
+		  "VariablePaperSize",
+		  "Version",
+		  "{",
+		  "}"
+		};
+
+
+//
+// Local functions...
+//
+
+static const char	*scan_plain(const char *ptr, const char *end,
+			            int quote, int *lines);
+
+
 //
 // 'ppdcSource::ppdcSource()' - Load a driver source file.
 //
@@ -58,6 +109,8 @@ ppdcSource::ppdcSource(const char  *f,	// I - File to read
   po_files      = new ppdcArray();
   sizes         = new ppdcArray();
   vars          = new ppdcArray();
+  size_index    = _ppdcIndexNew();
+  var_index     = _ppdcIndexNew();
   cond_state    = PPDC_COND_NORMAL;
   cond_current  = cond_stack;
   cond_stack[0] = PPDC_COND_NORMAL;
@@ -65,27 +118,27 @@ ppdcSource::ppdcSource(const char  *f,	// I - File to read
   // Add standard #define variables...
 #define MAKE_STRING(x) #x
 
-  vars->add(new ppdcVariable("CUPS_VERSION", MAKE_STRING(CUPS_VERSION)));
-  vars->add(new ppdcVariable("CUPS_VERSION_MAJOR", MAKE_STRING(CUPS_VERSION_MAJOR)));
-  vars->add(new ppdcVariable("CUPS_VERSION_MINOR", MAKE_STRING(CUPS_VERSION_MINOR)));
-  vars->add(new ppdcVariable("CUPS_VERSION_PATCH", MAKE_STRING(CUPS_VERSION_PATCH)));
+  add_variable(new ppdcVariable("CUPS_VERSION", MAKE_STRING(CUPS_VERSION)));
+  add_variable(new ppdcVariable("CUPS_VERSION_MAJOR", MAKE_STRING(CUPS_VERSION_MAJOR)));
+  add_variable(new ppdcVariable("CUPS_VERSION_MINOR", MAKE_STRING(CUPS_VERSION_MINOR)));
+  add_variable(new ppdcVariable("CUPS_VERSION_PATCH", MAKE_STRING(CUPS_VERSION_PATCH)));
 
 #ifdef _WIN32
-  vars->add(new ppdcVariable("PLATFORM_NAME", "Windows"));
-  vars->add(new ppdcVariable("PLATFORM_ARCH", "X86"));
+  add_variable(new ppdcVariable("PLATFORM_NAME", "Windows"));
+  add_variable(new ppdcVariable("PLATFORM_ARCH", "X86"));
 
 #else
   struct utsname name;			// uname information
 
   if (!uname(&name))
   {
-    vars->add(new ppdcVariable("PLATFORM_NAME", name.sysname));
-    vars->add(new ppdcVariable("PLATFORM_ARCH", name.machine));
+    add_variable(new ppdcVariable("PLATFORM_NAME", name.sysname));
+    add_variable(new ppdcVariable("PLATFORM_ARCH", name.machine));
   }
   else
   {
-    vars->add(new ppdcVariable("PLATFORM_NAME", "unknown"));
-    vars->add(new ppdcVariable("PLATFORM_ARCH", "unknown"));
+    add_variable(new ppdcVariable("PLATFORM_NAME", "unknown"));
+    add_variable(new ppdcVariable("PLATFORM_ARCH", "unknown"));
   }
 #endif // _WIN32
 
@@ -108,6 +161,8 @@ ppdcSource::~ppdcSource()
   po_files->release();
   sizes->release();
   vars->release();
+  cupsArrayDelete(size_index);
+  cupsArrayDelete(var_index);
 }
 
 
@@ -128,6 +183,36 @@ ppdcSource::add_include(const char *d)	// I - Include directory
 }
 
 
+//
+// 'ppdcSource::add_size()' - Add a predefined media size.
+//
+
+void
+ppdcSource::add_size(ppdcMediaSize *m)	// I - Media size
+{
+  sizes->add(m);
+
+  // Only index the first size with a given name, as find_size() did when
+  // it scanned the array...
+  if (!_ppdcIndexFind(size_index, m->name->value))
+    _ppdcIndexAdd(size_index, m->name->value, m);
+}
+
+
+//
+// 'ppdcSource::add_variable()' - Add a variable.
+//
+
+void
+ppdcSource::add_variable(ppdcVariable *v)// I - Variable
+{
+  vars->add(v);
+
+  if (!_ppdcIndexFind(var_index, v->name->value))
+    _ppdcIndexAdd(var_index, v->name->value, v);
+}
+
+
 //
 // 'ppdcSource::find_driver()' - Find a driver.
 //
@@ -267,14 +352,7 @@ ppdcSource::find_po(const char *l)	// I - Locale name
 ppdcMediaSize *				// O - Size
 ppdcSource::find_size(const char *s)	// I - Size name
 {
-  ppdcMediaSize	*m;			// Current media size
-
-
-  for (m = (ppdcMediaSize *)sizes->first(); m; m = (ppdcMediaSize *)sizes->next())
-    if (!strcasecmp(s, m->name->value))
-      return (m);
-
-  return (NULL);
+  return ((ppdcMediaSize *)_ppdcIndexFind(size_index, s));
 }
 
 
@@ -285,14 +363,7 @@ ppdcSource::find_size(const char *s)	// I - Size name
 ppdcVariable *				// O - Variable
 ppdcSource::find_variable(const char *n)// I - Variable name
 {
-  ppdcVariable	*v;			// Current variable
-
-
-  for (v = (ppdcVariable *)vars->first(); v; v = (ppdcVariable *)vars->next())
-    if (!strcasecmp(n, v->name->value))
-      return (v);
-
-  return (NULL);
+  return ((ppdcVariable *)_ppdcIndexFind(var_index, n));
 }
 
 
@@ -802,14 +873,14 @@ ppdcSource::get_duplex(ppdcFile   *fp,	// I - File to read from
   {
     g = d->find_group("General");
     if ((o = g->find_option("Duplex")) != NULL)
-      g->options->remove(o);
+      g->remove_option(o);
 
     for (attr = (ppdcAttr *)d->attrs->first();
          attr;
 	 attr = (ppdcAttr *)d->attrs->next())
       if (!strcmp(attr->name->value, "cupsFlipDuplex"))
       {
-        d->attrs->remove(attr);
+        d->remove_attr(attr);
 	break;
       }
   }
@@ -842,7 +913,7 @@ ppdcSource::get_duplex(ppdcFile   *fp,	// I - File to read from
       if (!strcmp(attr->name->value, "cupsFlipDuplex"))
       {
         if (strcasecmp(temp, "flip"))
-          d->attrs->remove(attr);
+          d->remove_attr(attr);
 	break;
       }
 
@@ -854,7 +925,7 @@ ppdcSource::get_duplex(ppdcFile   *fp,	// I - File to read from
 	 attr = (ppdcAttr *)d->attrs->next())
       if (!strcmp(attr->name->value, "cupsBackSide"))
       {
-        d->attrs->remove(attr);
+        d->remove_attr(attr);
 	break;
       }
 
@@ -1952,6 +2023,8 @@ ppdcSource::get_token(ppdcFile *fp,	// I - File to read
   char		name[256],		// Name string
 		*nameptr;		// Name pointer
   ppdcVariable	*var;			// Variable pointer
+  const char	*runptr;		// End of run in file buffer
+  size_t	runlen;			// Length of run
 
 
   // Mark the beginning and end of the buffer...
@@ -1963,8 +2036,50 @@ ppdcSource::get_token(ppdcFile *fp,	// I - File to read
   startline = 0;
   empty     = 1;
 
-  while ((ch = fp->get()) != EOF)
+  for (;;)
   {
+    // Copy runs of whitespace and plain characters straight from the file
+    // buffer, only special characters are handled one at a time below...
+    if (fp->bufptr >= fp->bufend && !fp->fill())
+      break;
+
+    if (empty && !quote)
+    {
+      for (runptr = fp->bufptr;
+           runptr < fp->bufend && isspace(*runptr & 255);
+	   runptr ++)
+	if (*runptr == '\n')
+	  fp->line ++;
+
+      fp->bufptr = (char *)runptr;
+
+      if (runptr >= fp->bufend)
+        continue;
+    }
+
+    runptr = scan_plain(fp->bufptr, fp->bufend, quote, &fp->line);
+
+    if (runptr > fp->bufptr)
+    {
+      empty  = 0;
+      runlen = (size_t)(runptr - fp->bufptr);
+
+      if (bufptr >= bufend)
+        runlen = 0;
+      else if (runlen > (size_t)(bufend - bufptr))
+        runlen = (size_t)(bufend - bufptr);
+
+      memcpy(bufptr, fp->bufptr, runlen);
+      bufptr     += runlen;
+      fp->bufptr = (char *)runptr;
+
+      if (runptr >= fp->bufend)
+        continue;
+    }
+
+    if ((ch = fp->get()) == EOF)
+      break;
+
     if (isspace(ch) && !quote)
     {
       if (empty)
@@ -2390,6 +2505,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
 		      bool       inc)	// I - Including?
 {
   ppdcDriver	*d;			// Current driver
+  ppdcArray	*groups;		// Groups that g, o, etc. belong to
   ppdcGroup	*g,			// Current group
 		*mg,			// Matching group
 		*general,		// General options group
@@ -2399,6 +2515,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
   char		temp[256],		// Token from file...
 		*ptr;			// Pointer into token
   int		isdefault;		// Default option?
+  size_t	i;			// Looping var
 
 
   // Initialize things as needed...
@@ -2410,21 +2527,16 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
   else
     d = new ppdcDriver(td);
 
-  if ((general = d->find_group("General")) == NULL)
-  {
-    general = new ppdcGroup("General", NULL);
-    d->add_group(general);
-  }
-
-  if ((install = d->find_group("InstallableOptions")) == NULL)
-  {
-    install = new ppdcGroup("InstallableOptions", "Installable Options");
-    d->add_group(install);
-  }
+  // The driver shares its groups with the template until it changes them,
+  // so the groups are looked up when the first directive that uses them
+  // is seen...
+  groups  = NULL;
+  general = NULL;
+  install = NULL;
 
   // Loop until EOF or }
   o = 0;
-  g = general;
+  g = 0;
 
   while (get_token(fp, temp, sizeof(temp)))
   {
@@ -2444,6 +2556,41 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
       isdefault = 0;
     }
 
+    for (i = 0; i < (sizeof(simple_directives) / sizeof(simple_directives[0])); i ++)
+      if (!strcasecmp(temp, simple_directives[i]))
+        break;
+
+    if (i >= (sizeof(simple_directives) / sizeof(simple_directives[0])))
+    {
+      // This directive may change the groups and options, so make sure we
+      // have our own copy of them...
+      d->unshare_groups();
+
+      if (groups != d->groups)
+      {
+        // Look up the groups and current option in the new copy...
+        groups = d->groups;
+
+	if ((general = d->find_group("General")) == NULL)
+	{
+	  general = new ppdcGroup("General", NULL);
+	  d->add_group(general);
+	}
+
+	if ((install = d->find_group("InstallableOptions")) == NULL)
+	{
+	  install = new ppdcGroup("InstallableOptions", "Installable Options");
+	  d->add_group(install);
+	}
+
+        if (!g || (g = d->find_group(g->name->value)) == NULL)
+	  g = general;
+
+        if (o)
+	  o = d->find_option(o->name->value);
+      }
+    }
+
     if (!strcasecmp(temp, "}"))
     {
       // Close this one out...
@@ -2632,7 +2779,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
         if (cond_state)
 	  m->release();
 	else
-          sizes->add(m);
+          add_size(m);
       }
     }
     else if (!strcasecmp(temp, "#po"))
@@ -2744,7 +2891,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
         if (cond_state)
 	  p->release();
 	else
-          d->profiles->add(p);
+          d->add_profile(p);
       }
     }
     else if (!strcasecmp(temp, "Copyright"))
@@ -2773,7 +2920,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
         if ((copyend = strchr(copyptr, '\n')) != NULL)
 	  *copyend++ = '\0';
 
-        d->copyright->add(new ppdcString(copyptr));
+        d->add_copyright(copyptr);
       }
     }
     else if (!strcasecmp(temp, "CustomMedia"))
@@ -2791,7 +2938,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
       }
 
       if (m)
-        d->sizes->add(m);
+        d->add_size(m);
 
       if (isdefault)
         d->set_default_size(m);
@@ -2905,7 +3052,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
         if (cond_state)
 	  f->release();
 	else
-          d->filters->add(f);
+          d->add_filter(f);
       }
     }
     else if (!strcasecmp(temp, "Finishing"))
@@ -3128,7 +3275,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
                              m->width, m->length, d->left_margin,
 			     d->bottom_margin, d->right_margin,
 			     d->top_margin);
-      d->sizes->add(dm);
+      d->add_size(dm);
 
       if (isdefault)
         d->set_default_size(dm);
@@ -3318,7 +3465,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
         if (cond_state)
 	  p->release();
 	else
-          d->profiles->add(p);
+          d->add_profile(p);
       }
     }
     else if (!strcasecmp(temp, "Throughput"))
@@ -3341,7 +3488,7 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
         if (cond_state)
 	  con->release();
 	else
-	  d->constraints->add(con);
+	  d->add_constraint(con);
       }
     }
     else if (!strcasecmp(temp, "VariablePaperSize"))
@@ -3389,7 +3536,14 @@ ppdcSource::scan_file(ppdcFile   *fp,	// I - File to read
     }
     else
     {
-      // Got a driver, save it...
+      // Got a driver, make sure it has the standard groups and save it...
+      if (!d->find_group("General"))
+        d->add_group(new ppdcGroup("General", NULL));
+
+      if (!d->find_group("InstallableOptions"))
+        d->add_group(new ppdcGroup("InstallableOptions",
+	                           "Installable Options"));
+
       drivers->add(d);
     }
   }
@@ -3421,7 +3575,7 @@ ppdcSource::set_variable(
   {
     // Create a new variable and add it...
     v = new ppdcVariable(name, value);
-    vars->add(v);
+    add_variable(v);
   }
 
   return (v);
@@ -3811,3 +3965,66 @@ ppdcSource::write_file(const char *f)	// I - File to write
 
   return (0);
 }
+
+
+//
+// 'scan_plain()' - Find the end of a run of plain token characters.
+//
+// Plain characters are copied to the token as they are.  Whitespace ends
+// a token outside of quotes and is plain inside of them.
+//
+
+static const char *			// O - First special character or end
+scan_plain(const char *ptr,		// I - Start of run
+           const char *end,		// I - End of buffer
+	   int        quote,		// I - Current quote character
+	   int        *lines)		// IO - Line number
+{
+  int	ch;				// Current character
+
+
+  for (; ptr < end; ptr ++)
+  {
+    ch = *ptr & 255;
+
+    switch (ch)
+    {
+      case '$' :
+      case '\\' :
+      case '\'' :
+      case '\"' :
+          return (ptr);
+
+      case '/' :
+      case '(' :
+      case '<' :
+      case '{' :
+      case '}' :
+          if (!quote)
+	    return (ptr);
+	  break;
+
+      case ')' :
+          if (quote == '(')
+	    return (ptr);
+	  break;
+
+      case '>' :
+          if (quote == '<')
+	    return (ptr);
+	  break;
+
+      default :
+          if (isspace(ch))
+	  {
+	    if (!quote)
+	      return (ptr);
+	    else if (ch == '\n')
+	      (*lines) ++;
+	  }
+	  break;
+    }
+  }
+
+  return (ptr);
+}
@@ -14,10 +14,12 @@
 
 #include <ppd/ppdc-private.h>
 #include <ppd/libcups2-private.h>
+#include <ppd/string-private.h>
 #include <cups/array.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 
 
 //
@@ -31,7 +33,14 @@ const char *progname;
 // Local functions...
 //
 
+static void	get_filename(ppdcDriver *d, const char *outdir, int comp,
+			     int use_model_name, char *filename,
+			     size_t filesize);
 static void	usage(void);
+static int	write_driver(ppdcDriver *d, cups_file_t *fp,
+			     ppdcCatalog *catalog, ppdcArray *locales,
+			     int single_language, ppdcSource *src,
+			     ppdcLineEnding le);
 
 
 //
@@ -43,6 +52,7 @@ main(int  argc,				// I - Number of command-line arguments
      char *argv[])			// I - Command-line arguments
 {
   int			i, j;		// Looping vars
+  int			jobs;		// Number of PPD writing processes
   ppdcCatalog		*catalog;	// Message catalog
   const char		*outdir;	// Output directory
   ppdcSource		*src;		// PPD source file data
@@ -50,11 +60,6 @@ main(int  argc,				// I - Number of command-line arguments
   cups_file_t		*fp;		// PPD file
   char			*opt,		// Current option
 			*value,		// Value in option
-			*outname,	// Output filename
-			make_model[1024],
-					// Make and model
-			pcfilename[1024],
-					// Lowercase pcfilename
 			filename[2048];	// PPD filename
   int			comp,		// Compress
 			do_test,	// Test PPD files
@@ -70,6 +75,7 @@ main(int  argc,				// I - Number of command-line arguments
   catalog         = NULL;
   comp            = 0;
   do_test         = 0;
+  jobs            = 1;
   le              = PPDC_LFONLY;
   locales         = NULL;
   outdir          = "ppd";
@@ -154,6 +160,12 @@ main(int  argc,				// I - Number of command-line arguments
 	      outdir = argv[i];
 	      break;
 
+          case 'j' :			// Number of processes...
+	      i ++;
+	      if (i >= argc || (jobs = atoi(argv[i])) < 1)
+        	usage();
+	      break;
+
           case 'l' :			// Language(s)...
 	      i ++;
 	      if (i >= argc)
@@ -274,144 +286,192 @@ main(int  argc,				// I - Number of command-line arguments
     }
 
     // Write PPD files...
-    for (d = (ppdcDriver *)src->drivers->first();
-         d;
-	 d = (ppdcDriver *)src->drivers->next())
+    if (jobs > 1 && !do_test)
     {
-      if (do_test)
+      // Write the PPD files from several processes.  All files are named
+      // up front so that overlapping filenames are still reported, and
+      // drivers sharing a filename are written by the same process, in
+      // order...
+      int	num_drivers = (int)src->drivers->count,
+					// Number of drivers
+		*workers = new int[num_drivers],
+					// Process writing each driver
+		worker,			// Current worker
+		status = 0;		// Exit status
+      char	**names = new char *[num_drivers];
+					// Filename of each driver
+      pid_t	*pids = new pid_t[jobs];// Worker processes
+
+      for (j = 0, d = (ppdcDriver *)src->drivers->first();
+           d;
+	   j ++, d = (ppdcDriver *)src->drivers->next())
       {
-        // Test the PPD file for this driver...
-	int	pid,			// Process ID
-		fds[2];			// Pipe file descriptors
-
+        get_filename(d, outdir, comp, use_model_name, filename,
+	             sizeof(filename));
 
-        if (pipe(fds))
-	{
+        if ((names[j] = (char *)cupsArrayFind(filenames, filename)) != NULL)
 	  fprintf(stderr,
-		  _("%s: Unable to create output pipes: %s\n"),
-		  progname, strerror(errno));
-	  return (1);
+		  _("%s: Warning - overlapping filename \"%s\".\n"),
+		  progname, filename);
+	else
+	{
+	  names[j] = strdup(filename);
+	  cupsArrayAdd(filenames, names[j]);
 	}
 
-	if ((pid = fork()) == 0)
-	{
-	  // Child process comes here...
-	  dup2(fds[0], 0);
+        workers[j] = (int)(_ppdHashString(names[j], 1) % (unsigned)jobs);
+      }
 
-	  close(fds[0]);
-	  close(fds[1]);
+      fflush(stdout);
+      fflush(stderr);
 
-	  execlp("cupstestppd", "cupstestppd", "-", (char *)0);
+      for (worker = 0; worker < jobs; worker ++)
+      {
+        if ((pids[worker] = fork()) == 0)
+	{
+	  // Child process comes here...
+	  for (j = 0, d = (ppdcDriver *)src->drivers->first();
+	       d;
+	       j ++, d = (ppdcDriver *)src->drivers->next())
+	  {
+	    if (workers[j] != worker)
+	      continue;
+
+	    if ((fp = cupsFileOpen(names[j], comp ? "w9" : "w")) == NULL)
+	    {
+	      fprintf(stderr,
+		      _("%s: Unable to create PPD file \"%s\" - %s.\n"),
+		      progname, names[j], strerror(errno));
+	      _exit(1);
+	    }
+
+	    if (verbose)
+	      fprintf(stdout, _("%s: Writing %s.\n"), progname, names[j]);
+
+	    if (write_driver(d, fp, catalog, locales, single_language, src, le))
+	    {
+	      cupsFileClose(fp);
+	      _exit(1);
+	    }
+
+	    cupsFileClose(fp);
+	  }
 
-	  fprintf(stderr,
-		  _("%s: Unable to execute cupstestppd: %s\n"),
-		  progname, strerror(errno));
-	  return (errno);
+	  fflush(stdout);
+	  _exit(0);
 	}
-	else if (pid < 0)
+	else if (pids[worker] < 0)
 	{
-	  fprintf(stderr, _("%s: Unable to execute cupstestppd: %s\n"),
-		  progname, strerror(errno));
-	  return (errno);
+	  fprintf(stderr, _("%s: Unable to fork: %s\n"), progname,
+		  strerror(errno));
+	  status = 1;
+	  break;
 	}
+      }
+
+      // Wait for the workers to finish...
+      while (worker > 0)
+      {
+        int	wstatus;		// Exit status of worker
 
-	close(fds[0]);
-	fp = cupsFileOpenFd(fds[1], "w");
+        worker --;
+
+        if (waitpid(pids[worker], &wstatus, 0) < 0 ||
+	    !WIFEXITED(wstatus) || WEXITSTATUS(wstatus))
+	  status = 1;
       }
-      else
+
+      delete[] pids;
+      delete[] names;
+      delete[] workers;
+
+      if (status)
+        return (1);
+    }
+    else
+    {
+      for (d = (ppdcDriver *)src->drivers->first();
+           d;
+	   d = (ppdcDriver *)src->drivers->next())
       {
-	// Write the PPD file for this driver...
-	if (use_model_name)
+	if (do_test)
 	{
-	  if (!strncasecmp(d->model_name->value, d->manufacturer->value,
-	                   strlen(d->manufacturer->value)))
+	  // Test the PPD file for this driver...
+	  int	pid,			// Process ID
+		fds[2];			// Pipe file descriptors
+
+
+	  if (pipe(fds))
 	  {
-	    // Model name already starts with the manufacturer...
-            outname = d->model_name->value;
+	    fprintf(stderr,
+		    _("%s: Unable to create output pipes: %s\n"),
+		    progname, strerror(errno));
+	    return (1);
 	  }
-	  else
+
+	  if ((pid = fork()) == 0)
 	  {
-	    // Add manufacturer to the front of the model name...
-	    snprintf(make_model, sizeof(make_model), "%s %s",
-	             d->manufacturer->value, d->model_name->value);
-	    outname = make_model;
-	  }
-	}
-	else if (d->file_name)
-	  outname = d->file_name->value;
-	else
-	  outname = d->pc_file_name->value;
+	    // Child process comes here...
+	    dup2(fds[0], 0);
 
-	if (strstr(outname, ".PPD"))
-	{
-	  // Convert PCFileName to lowercase...
-	  for (j = 0;
-	       outname[j] && j < (int)(sizeof(pcfilename) - 1);
-	       j ++)
-	    pcfilename[j] = (char)tolower(outname[j] & 255);
+	    close(fds[0]);
+	    close(fds[1]);
 
-	  pcfilename[j] = '\0';
-	}
-	else
-	{
-	  // Leave PCFileName as-is...
-	  strncpy(pcfilename, outname, sizeof(pcfilename));
-	}
+	    execlp("cupstestppd", "cupstestppd", "-", (char *)0);
 
-	// Open the PPD file for writing...
-	if (comp)
-	  snprintf(filename, sizeof(filename), "%s/%s.gz", outdir, pcfilename);
-	else
-	  snprintf(filename, sizeof(filename), "%s/%s", outdir, pcfilename);
+	    fprintf(stderr,
+		    _("%s: Unable to execute cupstestppd: %s\n"),
+		    progname, strerror(errno));
+	    return (errno);
+	  }
+	  else if (pid < 0)
+	  {
+	    fprintf(stderr, _("%s: Unable to execute cupstestppd: %s\n"),
+		    progname, strerror(errno));
+	    return (errno);
+	  }
 
-        if (cupsArrayFind(filenames, filename))
-	  fprintf(stderr,
-		  _("%s: Warning - overlapping filename \"%s\".\n"),
-		  progname, filename);
+	  close(fds[0]);
+	  fp = cupsFileOpenFd(fds[1], "w");
+	}
 	else
-	  cupsArrayAdd(filenames, strdup(filename));
-
-	fp = cupsFileOpen(filename, comp ? "w9" : "w");
-	if (!fp)
 	{
-	  fprintf(stderr,
-		  _("%s: Unable to create PPD file \"%s\" - %s.\n"),
-		  progname, filename, strerror(errno));
-	  return (1);
-	}
+	  // Write the PPD file for this driver...
+	  get_filename(d, outdir, comp, use_model_name, filename,
+		       sizeof(filename));
+
+	  if (cupsArrayFind(filenames, filename))
+	    fprintf(stderr,
+		    _("%s: Warning - overlapping filename \"%s\".\n"),
+		    progname, filename);
+	  else
+	    cupsArrayAdd(filenames, strdup(filename));
 
-	if (verbose)
-	  fprintf(stdout, _("%s: Writing %s.\n"), progname, filename);
-      }
+	  fp = cupsFileOpen(filename, comp ? "w9" : "w");
+	  if (!fp)
+	  {
+	    fprintf(stderr,
+		    _("%s: Unable to create PPD file \"%s\" - %s.\n"),
+		    progname, filename, strerror(errno));
+	    return (1);
+	  }
 
-      //
-      // Write the PPD file...
-      //
+	  if (verbose)
+	    fprintf(stdout, _("%s: Writing %s.\n"), progname, filename);
+	}
 
-      ppdcArray *templocales = locales;
+	//
+	// Write the PPD file...
+	//
 
-      if (!templocales && !single_language)
-      {
-	templocales = new ppdcArray();
-	for (ppdcCatalog *tempcatalog = (ppdcCatalog *)src->po_files->first();
-	     tempcatalog;
-	     tempcatalog = (ppdcCatalog *)src->po_files->next())
+	if (write_driver(d, fp, catalog, locales, single_language, src, le))
 	{
-	  tempcatalog->locale->retain();
-	  templocales->add(tempcatalog->locale);
+	  cupsFileClose(fp);
+	  return (1);
 	}
-      }
 
-      if (d->write_ppd_file(fp, catalog, templocales, src, le))
-      {
 	cupsFileClose(fp);
-	return (1);
       }
-
-      if (templocales && templocales != locales)
-        templocales->release();
-
-      cupsFileClose(fp);
     }
   }
   else
@@ -429,6 +489,68 @@ main(int  argc,				// I - Number of command-line arguments
 }
 
 
+//
+// 'get_filename()' - Get the PPD filename for a driver.
+//
+
+static void
+get_filename(ppdcDriver *d,		// I - Driver
+             const char *outdir,	// I - Output directory
+	     int        comp,		// I - Compress PPD files?
+	     int        use_model_name,	// I - Use ModelName for filename?
+	     char       *filename,	// I - Filename buffer
+	     size_t     filesize)	// I - Size of filename buffer
+{
+  int		j;			// Looping var
+  const char	*outname;		// Output filename
+  char		make_model[1024],	// Make and model
+		pcfilename[1024];	// Lowercase pcfilename
+
+
+  if (use_model_name)
+  {
+    if (!strncasecmp(d->model_name->value, d->manufacturer->value,
+		     strlen(d->manufacturer->value)))
+    {
+      // Model name already starts with the manufacturer...
+      outname = d->model_name->value;
+    }
+    else
+    {
+      // Add manufacturer to the front of the model name...
+      snprintf(make_model, sizeof(make_model), "%s %s",
+	       d->manufacturer->value, d->model_name->value);
+      outname = make_model;
+    }
+  }
+  else if (d->file_name)
+    outname = d->file_name->value;
+  else
+    outname = d->pc_file_name->value;
+
+  if (strstr(outname, ".PPD"))
+  {
+    // Convert PCFileName to lowercase...
+    for (j = 0;
+	 outname[j] && j < (int)(sizeof(pcfilename) - 1);
+	 j ++)
+      pcfilename[j] = (char)tolower(outname[j] & 255);
+
+    pcfilename[j] = '\0';
+  }
+  else
+  {
+    // Leave PCFileName as-is...
+    strncpy(pcfilename, outname, sizeof(pcfilename));
+  }
+
+  if (comp)
+    snprintf(filename, filesize, "%s/%s.gz", outdir, pcfilename);
+  else
+    snprintf(filename, filesize, "%s/%s", outdir, pcfilename);
+}
+
+
 //
 // 'usage()' - Show usage and exit.
 //
@@ -447,6 +569,8 @@ usage(void)
 		    "message catalog.\n"));
   fprintf(stdout, _("  -d output-dir           Specify the output "
 		    "directory.\n"));
+  fprintf(stdout, _("  -j jobs                 Write PPD files using "
+		    "multiple processes.\n"));
   fprintf(stdout, _("  -l lang[,lang,...]      Specify the output "
 		    "language(s) (locale).\n"));
   fprintf(stdout, _("  -m                      Use the ModelName value "
@@ -465,3 +589,42 @@ usage(void)
 
   exit(1);
 }
+
+
+//
+// 'write_driver()' - Write the PPD file for a driver.
+//
+
+static int				// O - 0 on success, 1 on error
+write_driver(ppdcDriver     *d,		// I - Driver
+             cups_file_t    *fp,	// I - PPD file
+	     ppdcCatalog    *catalog,	// I - Message catalog
+	     ppdcArray      *locales,	// I - List of locales
+	     int            single_language,
+					// I - Generate single-language files?
+	     ppdcSource     *src,	// I - PPD source file data
+	     ppdcLineEnding le)		// I - Line ending to use
+{
+  ppdcArray	*templocales = locales;	// Locales to write
+  int		status;			// Return status
+
+
+  if (!templocales && !single_language)
+  {
+    templocales = new ppdcArray();
+    for (ppdcCatalog *tempcatalog = (ppdcCatalog *)src->po_files->first();
+	 tempcatalog;
+	 tempcatalog = (ppdcCatalog *)src->po_files->next())
+    {
+      tempcatalog->locale->retain();
+      templocales->add(tempcatalog->locale);
+    }
+  }
+
+  status = d->write_ppd_file(fp, catalog, templocales, src, le) ? 1 : 0;
+
+  if (templocales && templocales != locales)
+    templocales->release();
+
+  return (status);
+}
@@ -16,6 +16,7 @@
 //
 
 #  include <cups/file.h>
+#  include <cups/array.h>
 #  include <stdlib.h>
 
 
@@ -99,6 +100,7 @@ class ppdcShared			//// Shared Data Value
 
   void		retain();
   void		release();
+  bool		shared() { return (use > 1); }
 };
 
 class ppdcArray				//// Shared Array
@@ -169,6 +171,7 @@ class ppdcCatalog			//// Translation catalog
   ppdcString	*locale;		// Name of locale
   ppdcString	*filename;		// Name of translation file
   ppdcArray	*messages;		// Array of translation messages
+  cups_array_t	*index;			// Messages hashed by ID
 
   ppdcCatalog(const char *l, const char *f = 0);
   ~ppdcCatalog();
@@ -265,6 +268,7 @@ class ppdcGroup			//// Group of Options
   ppdcString	*name,			// Name of option
 		*text;			// Human-readable text of option
   ppdcArray	*options;		// Options
+  cups_array_t	*option_index;		// Options by name
 
   ppdcGroup(const char *n, const char *t);
   ppdcGroup(ppdcGroup *g);
@@ -272,8 +276,9 @@ class ppdcGroup			//// Group of Options
 
   PPDC_NAME("ppdcGroup")
 
-  void		add_option(ppdcOption *o) { options->add(o); }
+  void		add_option(ppdcOption *o);
   ppdcOption	*find_option(const char *n);
+  void		remove_option(ppdcOption *o);
 };
 
 class ppdcConstraint			//// Constraint
@@ -374,6 +379,8 @@ class ppdcDriver			//// Printer Driver Data
 		*groups,		// Option groups
 		*profiles,		// Color profiles
 		*sizes;			// Fixed sizes
+  cups_array_t	*attr_index,		// Attributes by name
+		*group_index;		// Groups by name
   ppdcString	*default_font,		// Default font
 		*default_size;		// Default size option
   int		variable_paper_size;	// Support variable sizes?
@@ -392,22 +399,23 @@ class ppdcDriver			//// Printer Driver Data
 
   PPDC_NAME("ppdcDriver")
 
-  void		add_attr(ppdcAttr *a) { attrs->add(a); }
-  void		add_constraint(ppdcConstraint *c) { constraints->add(c); }
-  void		add_copyright(const char *c) {
-    		  copyright->add(new ppdcString(c));
-		}
-  void		add_filter(ppdcFilter *f) { filters->add(f); }
-  void		add_font(ppdcFont *f) { fonts->add(f); }
-  void		add_group(ppdcGroup *g) { groups->add(g); }
-  void		add_profile(ppdcProfile *p) { profiles->add(p); }
-  void		add_size(ppdcMediaSize *m) { sizes->add(m); }
+  void		add_attr(ppdcAttr *a);
+  void		add_constraint(ppdcConstraint *c);
+  void		add_copyright(const char *c);
+  void		add_filter(ppdcFilter *f);
+  void		add_font(ppdcFont *f);
+  void		add_group(ppdcGroup *g);
+  void		add_profile(ppdcProfile *p);
+  void		add_size(ppdcMediaSize *m);
 
   ppdcAttr	*find_attr(const char *k, const char *s);
   ppdcGroup	*find_group(const char *n);
   ppdcOption	*find_option(const char *n);
   ppdcOption	*find_option_group(const char *n, ppdcGroup **mg);
 
+  void		remove_attr(ppdcAttr *a);
+  void		unshare_groups();
+
   void		set_custom_size_code(const char *c);
   void		set_default_font(ppdcFont *f);
   void		set_default_size(ppdcMediaSize *m);
@@ -446,10 +454,14 @@ class ppdcFile				//// File
   cups_file_t	*fp;			// File pointer
   const char	*filename;		// Filename
   int		line;			// Line in file
+  char		buffer[8192],		// Read buffer
+		*bufptr,		// Current position in buffer
+		*bufend;		// End of buffer
 
   ppdcFile(const char *f, cups_file_t *ffp = (cups_file_t *)0);
   ~ppdcFile();
 
+  bool		fill();
   int		get();
   int		peek();
 };
@@ -468,6 +480,8 @@ class ppdcSource			//// Source File
 		*po_files,		// Message catalogs
 		*sizes,			// Predefined media sizes
 		*vars;			// Defined variables
+  cups_array_t	*size_index,		// Media sizes by name
+		*var_index;		// Variables by name
   int		cond_state,		// Cumulative conditional state
 		*cond_current,		// Current #if state
 		cond_stack[101];	// #if state stack
@@ -479,6 +493,8 @@ class ppdcSource			//// Source File
   PPDC_NAME("ppdcSource")
 
   static void	add_include(const char *d);
+  void		add_size(ppdcMediaSize *m);
+  void		add_variable(ppdcVariable *v);
   ppdcDriver	*find_driver(const char *f);
   static char	*find_include(const char *f, const char *base, char *n,
 			      int nlen);
@@ -14,15 +14,24 @@
 
 #include <ppd/ppdc-private.h>
 #include <ppd/libcups2-private.h>
+#include <ppd/string-private.h>
 #include <ppd/ppd.h>
 #include <cups/array.h>
 //#include <errno.h>
 
 
+//
+// Constants...
+//
+
+#define LOCALE_HASHSIZE	64		// Size of locale hash table
+
+
 //
 // Local functions...
 //
 
+static int		hash_locale(const char *locale, void *data);
 static const char	*ppd_locale(ppd_file_t *ppd);
 static void		usage(void);
 
@@ -43,18 +52,22 @@ main(int  argc,				// I - Number of command-line arguments
 		*outname;		// Output filename (if any)
   char		bckname[1024];		// Backup filename
   cups_file_t	*infile,		// Input file
+		*enfile,		// English input file
 		*outfile;		// Output file
-  cups_array_t	*languages;		// Languages in file
+  cups_array_t	*enlanguages,		// Languages in English file
+		*languages;		// Languages in output file
+  char		*enlang;		// Language in English file
   const char	*locale;		// Current locale
   char		line[1024];		// Line from file
 
 
   // Scan the command-line...
-  inname    = NULL;
-  outname   = NULL;
-  outfile   = NULL;
-  languages = NULL;
-  ppds      = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+  inname      = NULL;
+  outname     = NULL;
+  enfile      = NULL;
+  outfile     = NULL;
+  enlanguages = NULL;
+  ppds        = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
 
   for (i = 1; i < argc; i ++)
     if (argv[i][0] == '-')
@@ -132,9 +145,13 @@ main(int  argc,				// I - Number of command-line arguments
 
       if (!strcmp(locale, "en") && !inname && !outfile)
       {
-        // Set the English PPD's filename...
-	inname    = argv[i];
-	languages = ppdGetLanguages(ppd);
+        // Set the English PPD's filename, the file is kept open so that we
+	// can copy it without opening it again...
+	inname      = argv[i];
+	enfile      = infile;
+	enlanguages = ppdGetLanguages(ppd);
+
+	ppdClose(ppd);
 
         if (outname && !strcmp(inname, outname))
 	{
@@ -166,16 +183,33 @@ main(int  argc,				// I - Number of command-line arguments
       }
 
       // Close and move on...
-      cupsFileClose(infile);
+      if (infile != enfile)
+        cupsFileClose(infile);
     }
 
   // If no PPDs have been loaded, display the program usage message.
   if (!inname)
     usage();
 
-  // Loop through the PPD files we loaded to generate a new language list...
-  if (!languages)
-    languages = cupsArrayNew((cups_array_cb_t)strcmp, NULL, NULL, 0, NULL, NULL);
+  // Loop through the PPD files we loaded to generate a new language list.
+  // The array keeps its own copies of the locale strings since
+  // ppd_locale() always returns the same buffer...
+  languages = cupsArrayNew((cups_array_cb_t)strcmp, NULL,
+                           (cups_ahash_cb_t)hash_locale, LOCALE_HASHSIZE,
+			   (cups_acopy_cb_t)strdup, (cups_afree_cb_t)free);
+
+  if (enlanguages)
+  {
+    for (enlang = (char *)cupsArrayGetFirst(enlanguages);
+         enlang;
+	 enlang = (char *)cupsArrayGetNext(enlanguages))
+    {
+      cupsArrayAdd(languages, enlang);
+      free(enlang);
+    }
+
+    cupsArrayDelete(enlanguages);
+  }
 
   for (ppd = (ppd_file_t *)cupsArrayGetFirst(ppds);
        ppd;
@@ -194,7 +228,8 @@ main(int  argc,				// I - Number of command-line arguments
   }
 
   // Copy the English PPD starting with a cupsLanguages line...
-  infile = cupsFileOpen(inname, "r");
+  infile = enfile;
+  cupsFileRewind(infile);
 
   if (outname)
   {
@@ -223,6 +258,8 @@ main(int  argc,				// I - Number of command-line arguments
       cupsFilePrintf(outfile, "%s\n", line);
   }
 
+  cupsFileClose(infile);
+
   // Loop through the other PPD files we loaded to provide the translations...
   for (ppd = (ppd_file_t *)cupsArrayGetFirst(ppds);
        ppd;
@@ -274,6 +311,7 @@ main(int  argc,				// I - Number of command-line arguments
   }
 
   cupsArrayDelete(ppds);
+  cupsArrayDelete(languages);
 
   cupsFileClose(outfile);
 
@@ -282,6 +320,20 @@ main(int  argc,				// I - Number of command-line arguments
 }
 
 
+//
+// 'hash_locale()' - Compute the hash of a locale string.
+//
+
+static int				// O - Hash value
+hash_locale(const char *locale,		// I - Locale string
+            void       *data)		// I - Callback data (unused)
+{
+  (void)data;
+
+  return ((int)(_ppdHashString(locale, 0) % LOCALE_HASHSIZE));
+}
+
+
 //
 // 'ppd_locale()' - Return the locale associated with a PPD file.
 //
@@ -124,7 +124,7 @@ _ppdRasterClearError(void)
 const char *				// O - Last error
 _ppdRasterErrorString(void)
 {
-  if (buf->current == buf->start)
+  if (!buf || buf->current == buf->start)
     return (NULL);
   else
     return (buf->start);
@@ -16,9 +16,20 @@
 #include <ppd/ppd.h>
 #include <ppd/debug-internal.h>
 #include <ppd/libcups2-private.h>
+#include <ppd/thread-private.h>
 #include <math.h>
 
 
+//
+// Constants...
+//
+
+#define PPD_MAX_EXEC_CODE	4096	// Max length of remembered code
+#define PPD_MAX_EXEC_MEMO	8	// Max remembered ppdRasterExecPS() calls
+#define PPD_MAX_HEADER_MEMO	8	// Max remembered page headers per PPD
+#define PPD_PS_STACK_SIZE	64	// Objects on stack without allocation
+
+
 //
 // Stack values for the PostScript mini-interpreter...
 //
@@ -65,25 +76,106 @@ typedef struct
   int			num_objs,	// Number of objects on stack
 			alloc_objs;	// Number of allocated objects
   _ppd_ps_obj_t	*objs;		// Objects in stack
+  _ppd_ps_obj_t	*buffer;	// Initial storage for objects, not
+					// allocated by the stack
 } _ppd_ps_stack_t;
 
+//
+// PostScript code of a PPD choice (or the patch code), compiled into the
+// dictionaries which it passes to setpagedevice...
+//
+
+typedef struct
+{
+  const char		*code;		// Code this was compiled from
+  int			status;		// 0 if compiled, -1 if code needs to
+					// get interpreted on each call
+  int			num_objs,	// Number of dictionary objects
+			alloc_objs;	// Number of allocated objects
+  _ppd_ps_obj_t		*objs;		// Objects of the dictionaries
+} _ppd_ps_code_t;
+
+//
+// Page header computed by ppdRasterInterpretPPD() for a set of marked
+// choices, before applying margins, orientation, and the callback...
+//
+
+typedef struct
+{
+  cups_page_header_t	header;		// Page header
+  int			preferred_bits;	// Preferred bits per color
+  unsigned		hash;		// Hash of marked choices
+  int			num_marked;	// Number of marked choices
+  ppd_choice_t		*marked[1];	// Marked choices (variable length)
+} _ppd_header_memo_t;
+
+//
+// Result of a ppdRasterExecPS() call...
+//
+
+typedef struct
+{
+  char			code[PPD_MAX_EXEC_CODE];
+					// PostScript code, "" if unused
+  unsigned		hash;		// Hash of code
+  unsigned		last_used;	// Use counter value of last use
+  int			in_bits,	// Preferred bits before
+			out_bits;	// Preferred bits after
+  cups_page_header_t	in,		// Page header before
+			out;		// Page header after
+} _ppd_exec_memo_t;
+
+
+//
+// Local globals...
+//
+
+static _ppd_mutex_t	exec_mutex = _PPD_MUTEX_INITIALIZER;
+					// Mutex to control access to memo
+static _ppd_exec_memo_t	exec_memo[PPD_MAX_EXEC_MEMO];
+					// Remembered ppdRasterExecPS() calls
+static unsigned		exec_used = 0;	// Use counter
+
 
 //
 // Local functions...
 //
 
 static int		ppd_cleartomark_stack(_ppd_ps_stack_t *st);
+static int		ppd_compare_code(_ppd_ps_code_t *a, _ppd_ps_code_t *b,
+			                 void *data);
+static _ppd_ps_code_t	*ppd_compile_code(ppd_file_t *ppd, const char *code,
+			                  int wrap);
 static int		ppd_copy_stack(_ppd_ps_stack_t *st, int count);
+static void		ppd_delete_code(_ppd_ps_code_t *c, void *data);
 static void		ppd_delete_stack(_ppd_ps_stack_t *st);
 static void		ppd_error_object(_ppd_ps_obj_t *obj);
 static void		ppd_error_stack(_ppd_ps_stack_t *st, const char *title);
+static int		ppd_exec_choices(cups_page_header_t *h,
+			                 int *preferred_bits, ppd_file_t *ppd,
+					 ppd_section_t section);
+static void		ppd_exec_code(cups_page_header_t *h,
+			              int *preferred_bits, _ppd_ps_code_t *c);
+static int		ppd_exec_ps(cups_page_header_t *h, int *preferred_bits,
+			            const char *code, _ppd_ps_code_t *record);
+static int		ppd_grow_stack(_ppd_ps_stack_t *st, int count);
 static _ppd_ps_obj_t	*ppd_index_stack(_ppd_ps_stack_t *st, int n);
-static _ppd_ps_stack_t	*ppd_new_stack(void);
+static void		ppd_init_stack(_ppd_ps_stack_t *st,
+			               _ppd_ps_obj_t *buffer, int count);
+static void		ppd_memo_add(ppd_file_t *ppd, _ppd_header_memo_t *key,
+			             cups_page_header_t *h,
+				     int preferred_bits);
+static _ppd_header_memo_t *ppd_memo_find(ppd_file_t *ppd,
+			                 _ppd_header_memo_t *key);
+static _ppd_header_memo_t *ppd_memo_new(ppd_file_t *ppd);
 static _ppd_ps_obj_t	*ppd_pop_stack(_ppd_ps_stack_t *st);
 static _ppd_ps_obj_t	*ppd_push_stack(_ppd_ps_stack_t *st,
 			            _ppd_ps_obj_t *obj);
+static int		ppd_record_dict(_ppd_ps_stack_t *st,
+			                _ppd_ps_code_t *record);
 static int		ppd_roll_stack(_ppd_ps_stack_t *st, int c, int s);
-static _ppd_ps_obj_t	*ppd_scan_ps(_ppd_ps_stack_t *st, char **ptr);
+static _ppd_ps_obj_t	*ppd_scan_ps(_ppd_ps_stack_t *st,
+			             const char **ptr);
 static int		ppd_setpagedevice(_ppd_ps_stack_t *st,
 			                cups_page_header_t *h,
 			                int *preferred_bits);
@@ -120,6 +212,13 @@ static void		ppd_DEBUG_stack(const char *prefix, _ppd_ps_stack_t *st);
 // @code pop@, @code roll@, @code setpagedevice@, and @code stopped@ operators
 // are supported.
 //
+// The code of each choice is only interpreted the first time it is used,
+// the dictionaries it passes to @code setpagedevice@ are kept with the PPD
+// and applied directly on subsequent calls.  In addition the page headers
+// resulting from the last few distinct sets of marked choices are kept, so
+// jobs switching between a few option sets per page do not need to apply
+// the code of the choices again.
+//
 // @since CUPS 1.2/macOS 10.5@
 //
 
@@ -133,7 +232,6 @@ ppdRasterInterpretPPD(
 					//     (@code NULL@ for none)
 {
   int		status;			// Cumulative status
-  char		*code;			// Code to run
   const char	*val;			// Option value
   ppd_size_t	*size;			// Current size
   float		left,			// Left position
@@ -142,6 +240,8 @@ ppdRasterInterpretPPD(
 		top,			// Top position
 		temp1, temp2;		// Temporary variables for swapping
   int		preferred_bits;		// Preferred bits per color
+  _ppd_header_memo_t *key,		// Marked choices
+		*memo;			// Remembered page header
 
 
   //
@@ -199,38 +299,58 @@ ppdRasterInterpretPPD(
   if (ppd)
   {
     //
-    // Apply any patch code (used to override the defaults...)
+    // Look for the page header of an earlier call with the same marked
+    // choices...
     //
 
-    if (ppd->patches)
-      status |= ppdRasterExecPS(h, &preferred_bits, ppd->patches);
-
-    //
-    // Then apply printer options in the proper order...
-    //
+    ppdHandleMedia(ppd);
 
-    if ((code = ppdEmitString(ppd, PPD_ORDER_DOCUMENT, 0.0)) != NULL)
+    if ((key = ppd_memo_new(ppd)) != NULL &&
+        (memo = ppd_memo_find(ppd, key)) != NULL)
     {
-      status |= ppdRasterExecPS(h, &preferred_bits, code);
-      free(code);
-    }
+      DEBUG_puts("4ppdRasterInterpretPPD: Using remembered page header.");
 
-    if ((code = ppdEmitString(ppd, PPD_ORDER_ANY, 0.0)) != NULL)
-    {
-      status |= ppdRasterExecPS(h, &preferred_bits, code);
-      free(code);
-    }
+      memcpy(h, &memo->header, sizeof(cups_page_header_t));
+      preferred_bits = memo->preferred_bits;
 
-    if ((code = ppdEmitString(ppd, PPD_ORDER_PROLOG, 0.0)) != NULL)
-    {
-      status |= ppdRasterExecPS(h, &preferred_bits, code);
-      free(code);
+      free(key);
     }
-
-    if ((code = ppdEmitString(ppd, PPD_ORDER_PAGE, 0.0)) != NULL)
+    else
     {
-      status |= ppdRasterExecPS(h, &preferred_bits, code);
-      free(code);
+      //
+      // Apply any patch code (used to override the defaults...)
+      //
+
+      if (ppd->patches)
+      {
+	_ppd_ps_code_t *c = ppd_compile_code(ppd, ppd->patches, 0);
+
+	if (c && !c->status)
+	  ppd_exec_code(h, &preferred_bits, c);
+	else
+	  status |= ppdRasterExecPS(h, &preferred_bits, ppd->patches);
+      }
+
+      //
+      // Then apply printer options in the proper order...
+      //
+
+      status |= ppd_exec_choices(h, &preferred_bits, ppd, PPD_ORDER_DOCUMENT);
+      status |= ppd_exec_choices(h, &preferred_bits, ppd, PPD_ORDER_ANY);
+      status |= ppd_exec_choices(h, &preferred_bits, ppd, PPD_ORDER_PROLOG);
+      status |= ppd_exec_choices(h, &preferred_bits, ppd, PPD_ORDER_PAGE);
+
+      //
+      // Remember the result for the next call with the same choices...
+      //
+
+      if (key)
+      {
+	if (!status && !_ppdRasterErrorString())
+	  ppd_memo_add(ppd, key, h, preferred_bits);
+	else
+	  free(key);
+      }
     }
   }
 
@@ -664,203 +784,209 @@ ppdRasterExecPS(
     int                 *preferred_bits,// O - Preferred bits per color
     const char          *code)		// I - PS code to execute
 {
-  int			error = 0;	// Error condition?
-  _ppd_ps_stack_t	*st;		// PostScript value stack
-  _ppd_ps_obj_t	*obj;			// Object from top of stack
-  char			*codecopy,	// Copy of code
-			*codeptr;	// Pointer into copy of code
+  int			status;		// Return status
+  int			i;		// Looping var
+  unsigned		hash;		// Hash of code
+  _ppd_exec_memo_t	*memo,		// Current remembered call
+			*oldest;	// Least recently used call
+  cups_page_header_t	in;		// Page header before
+  int			in_bits;	// Preferred bits before
+  const char		*errors;	// Error messages so far
+  size_t		errlen;		// Length of error messages
 
 
-  DEBUG_printf(("ppdRasterExecPS(h=%p, preferred_bits=%p, code=\"%s\")\n",
-                h, preferred_bits, code));
+  //
+  // Only short code is remembered, the memo must not hold on to memory...
+  //
+
+  if (!h || !preferred_bits || !code || strlen(code) >= PPD_MAX_EXEC_CODE)
+    return (ppd_exec_ps(h, preferred_bits, code, NULL));
 
   //
-  // Copy the PostScript code and create a stack...
+  // See if we already executed this code on this page header...
   //
 
-  if ((codecopy = strdup(code)) == NULL)
-  {
-    _ppdRasterAddError("Unable to duplicate code string.\n");
-    return (-1);
-  }
+  hash = _ppdHashString(code, 0);
 
-  if ((st = ppd_new_stack()) == NULL)
+  _ppdMutexLock(&exec_mutex);
+
+  for (i = PPD_MAX_EXEC_MEMO, memo = exec_memo; i > 0; i --, memo ++)
   {
-    _ppdRasterAddError("Unable to create stack.\n");
-    free(codecopy);
-    return (-1);
+    if (memo->code[0] && memo->hash == hash &&
+        memo->in_bits == *preferred_bits && !strcmp(memo->code, code) &&
+	!memcmp(&memo->in, h, sizeof(cups_page_header_t)))
+    {
+      DEBUG_puts("4ppdRasterExecPS: Using remembered page header.");
+
+      memo->last_used = ++ exec_used;
+      memcpy(h, &memo->out, sizeof(cups_page_header_t));
+      *preferred_bits = memo->out_bits;
+
+      _ppdMutexUnlock(&exec_mutex);
+
+      return (0);
+    }
   }
 
+  _ppdMutexUnlock(&exec_mutex);
+
   //
-  // Parse the PS string until we run out of data...
+  // No, execute it...
   //
 
-  codeptr = codecopy;
+  in      = *h;
+  in_bits = *preferred_bits;
 
-  while ((obj = ppd_scan_ps(st, &codeptr)) != NULL)
-  {
-#ifdef DEBUG
-    DEBUG_printf(("ppdRasterExecPS: Stack (%d objects)", st->num_objs));
-    ppd_DEBUG_object("ppdRasterExecPS", obj);
-#endif // DEBUG
+  errors = _ppdRasterErrorString();
+  errlen = errors ? strlen(errors) : 0;
 
-    switch (obj->type)
-    {
-      default :
-          // Do nothing for regular values
-	  break;
+  status = ppd_exec_ps(h, preferred_bits, code, NULL);
 
-      case PPD_PS_CLEARTOMARK :
-          ppd_pop_stack(st);
+  errors = _ppdRasterErrorString();
 
-	  if (ppd_cleartomark_stack(st))
-	    _ppdRasterAddError("cleartomark: Stack underflow.\n");
+  if (!status && (errors ? strlen(errors) : 0) == errlen)
+  {
+    //
+    // Remember the result in place of the least recently used call...
+    //
 
-#ifdef DEBUG
-          DEBUG_puts("1_ppdRasterExecPS:    dup");
-	  ppd_DEBUG_stack("ppdRasterExecPS", st);
-#endif // DEBUG
-          break;
+    _ppdMutexLock(&exec_mutex);
 
-      case PPD_PS_COPY :
-          ppd_pop_stack(st);
-	  if ((obj = ppd_pop_stack(st)) != NULL)
-	  {
-	    ppd_copy_stack(st, (int)obj->value.number);
+    for (i = PPD_MAX_EXEC_MEMO, memo = exec_memo, oldest = exec_memo;
+         i > 0;
+	 i --, memo ++)
+      if (!memo->code[0] ||
+          (oldest->code[0] && memo->last_used < oldest->last_used))
+	oldest = memo;
 
-#ifdef DEBUG
-            DEBUG_puts("ppdRasterExecPS: copy");
-	    ppd_DEBUG_stack("ppdRasterExecPS", st);
-#endif // DEBUG
-          }
-          break;
+    strlcpy(oldest->code, code, sizeof(oldest->code));
+    oldest->hash      = hash;
+    oldest->last_used = ++ exec_used;
+    oldest->in        = in;
+    oldest->in_bits   = in_bits;
+    oldest->out       = *h;
+    oldest->out_bits  = *preferred_bits;
 
-      case PPD_PS_DUP :
-          ppd_pop_stack(st);
-	  ppd_copy_stack(st, 1);
+    _ppdMutexUnlock(&exec_mutex);
+  }
 
-#ifdef DEBUG
-          DEBUG_puts("ppdRasterExecPS: dup");
-	  ppd_DEBUG_stack("ppdRasterExecPS", st);
-#endif // DEBUG
-          break;
+  return (status);
+}
 
-      case PPD_PS_INDEX :
-          ppd_pop_stack(st);
-	  if ((obj = ppd_pop_stack(st)) != NULL)
-	  {
-	    ppd_index_stack(st, (int)obj->value.number);
 
-#ifdef DEBUG
-            DEBUG_puts("ppdRasterExecPS: index");
-	    ppd_DEBUG_stack("ppdRasterExecPS", st);
-#endif // DEBUG
-          }
-          break;
+//
+// 'ppd_cleartomark_stack()' - Clear to the last mark ([) on the stack.
+//
 
-      case PPD_PS_POP :
-          ppd_pop_stack(st);
-          ppd_pop_stack(st);
+static int					// O - 0 on success, -1 on error
+ppd_cleartomark_stack(_ppd_ps_stack_t *st)	// I - Stack
+{
+  _ppd_ps_obj_t	*obj;		// Current object on stack
 
-#ifdef DEBUG
-          DEBUG_puts("ppdRasterExecPS: pop");
-	  ppd_DEBUG_stack("ppdRasterExecPS", st);
-#endif // DEBUG
-          break;
 
-      case PPD_PS_ROLL :
-          ppd_pop_stack(st);
-	  if ((obj = ppd_pop_stack(st)) != NULL)
-	  {
-            int		c;		// Count
+  while ((obj = ppd_pop_stack(st)) != NULL)
+    if (obj->type == PPD_PS_START_ARRAY)
+      break;
 
+  return (obj ? 0 : -1);
+}
 
-            c = (int)obj->value.number;
 
-	    if ((obj = ppd_pop_stack(st)) != NULL)
-	    {
-	      ppd_roll_stack(st, (int)obj->value.number, c);
+//
+// 'ppd_compare_code()' - Compare two compiled code records.
+//
 
-#ifdef DEBUG
-              DEBUG_puts("ppdRasterExecPS: roll");
-	      ppd_DEBUG_stack("ppdRasterExecPS", st);
-#endif // DEBUG
-            }
-	  }
-          break;
+static int				// O - Result of comparison
+ppd_compare_code(_ppd_ps_code_t *a,	// I - First code
+                 _ppd_ps_code_t *b,	// I - Second code
+		 void           *data)	// I - Callback data (unused)
+{
+  (void)data;
 
-      case PPD_PS_SETPAGEDEVICE :
-          ppd_pop_stack(st);
-	  ppd_setpagedevice(st, h, preferred_bits);
+  if (a->code < b->code)
+    return (-1);
+  else if (a->code > b->code)
+    return (1);
+  else
+    return (0);
+}
 
-#ifdef DEBUG
-          DEBUG_puts("ppdRasterExecPS: setpagedevice");
-	  ppd_DEBUG_stack("ppdRasterExecPS", st);
-#endif // DEBUG
-          break;
 
-      case PPD_PS_START_PROC :
-      case PPD_PS_END_PROC :
-      case PPD_PS_STOPPED :
-          ppd_pop_stack(st);
-	  break;
+//
+// 'ppd_compile_code()' - Get the compiled form of a choice's code.
+//
+// The code is interpreted once on a scratch page header, recording the
+// dictionaries passed to setpagedevice.  Code which does anything else
+// visible (adding error messages or leaving objects on the stack) is
+// marked to be interpreted on each call.
+//
 
-      case PPD_PS_OTHER :
-          _ppdRasterAddError("Unknown operator \"%s\".\n", obj->value.other);
-	  error = 1;
-          DEBUG_printf(("ppdRasterExecPS: Unknown operator \"%s\".", obj->value.other));
-          break;
-    }
+static _ppd_ps_code_t *			// O - Compiled code or NULL on error
+ppd_compile_code(ppd_file_t *ppd,	// I - PPD file
+                 const char *code,	// I - PS code of choice or patches
+		 int        wrap)	// I - Wrap like ppdEmitString() does?
+{
+  _ppd_ps_code_t	key,		// Search key
+			*c;		// Compiled code
+  cups_page_header_t	h;		// Scratch page header
+  int			preferred_bits = 0;
+					// Scratch preferred bits
+  char			*wrapped = NULL;// Code with error handling wrapper
+  const char		*errors;	// Error messages so far
+  size_t		errlen;		// Length of error messages
+
+
+  if (!ppd->raster_code &&
+      (ppd->raster_code = cupsArrayNew((cups_array_cb_t)ppd_compare_code,
+                                       NULL, NULL, 0, NULL,
+				       (cups_afree_cb_t)ppd_delete_code))
+          == NULL)
+    return (NULL);
 
-    if (error)
-      break;
-  }
+  key.code = code;
 
-  //
-  // Cleanup...
-  //
+  if ((c = (_ppd_ps_code_t *)cupsArrayFind(ppd->raster_code, &key)) != NULL)
+    return (c);
 
-  free(codecopy);
+  if ((c = calloc(1, sizeof(_ppd_ps_code_t))) == NULL)
+    return (NULL);
 
-  if (st->num_objs > 0)
-  {
-    ppd_error_stack(st, "Stack not empty:");
+  c->code = code;
 
-#ifdef DEBUG
-    DEBUG_puts("ppdRasterExecPS: Stack not empty");
-    ppd_DEBUG_stack("ppdRasterExecPS", st);
-#endif // DEBUG
+  if (wrap)
+  {
+    size_t len = strlen(code) + 28;	// Length of wrapped code
 
-    ppd_delete_stack(st);
+    if ((wrapped = malloc(len)) == NULL)
+    {
+      free(c);
+      return (NULL);
+    }
 
-    return (-1);
+    snprintf(wrapped, len, "[{\n%s\n} stopped cleartomark\n", code);
+    code = wrapped;
   }
 
-  ppd_delete_stack(st);
-
-  //
-  // Return success...
-  //
+  errors = _ppdRasterErrorString();
+  errlen = errors ? strlen(errors) : 0;
 
-  return (0);
-}
+  memset(&h, 0, sizeof(h));
 
+  if (ppd_exec_ps(&h, &preferred_bits, code, c))
+    c->status = -1;
 
-//
-// 'ppd_cleartomark_stack()' - Clear to the last mark ([) on the stack.
-//
+  errors = _ppdRasterErrorString();
+  if ((errors ? strlen(errors) : 0) != errlen)
+    c->status = -1;
 
-static int					// O - 0 on success, -1 on error
-ppd_cleartomark_stack(_ppd_ps_stack_t *st)	// I - Stack
-{
-  _ppd_ps_obj_t	*obj;		// Current object on stack
+  free(wrapped);
 
+  DEBUG_printf(("4ppd_compile_code: %d dictionary objects, status %d",
+                c->num_objs, c->status));
 
-  while ((obj = ppd_pop_stack(st)) != NULL)
-    if (obj->type == PPD_PS_START_ARRAY)
-      break;
+  cupsArrayAdd(ppd->raster_code, c);
 
-  return (obj ? 0 : -1);
+  return (c);
 }
 
 
@@ -883,19 +1009,37 @@ ppd_copy_stack(_ppd_ps_stack_t *st,	// I - Stack
   if ((n = st->num_objs - c) < 0)
     return (-1);
 
-  while (c > 0)
-  {
-    if (!ppd_push_stack(st, st->objs + n))
-      return (-1);
+  //
+  // Make room for all copies first, so that the objects we copy from don't
+  // move while copying...
+  //
 
-    n ++;
-    c --;
-  }
+  if (st->num_objs + c > st->alloc_objs && ppd_grow_stack(st, c))
+    return (-1);
+
+  memcpy(st->objs + st->num_objs, st->objs + n,
+         (size_t)c * sizeof(_ppd_ps_obj_t));
+  st->num_objs += c;
 
   return (0);
 }
 
 
+//
+// 'ppd_delete_code()' - Free memory used by compiled code.
+//
+
+static void
+ppd_delete_code(_ppd_ps_code_t *c,	// I - Compiled code
+                void           *data)	// I - Callback data (unused)
+{
+  (void)data;
+
+  free(c->objs);
+  free(c);
+}
+
+
 //
 // 'ppd_delete_stack()' - Free memory used by a stack.
 //
@@ -903,8 +1047,8 @@ ppd_copy_stack(_ppd_ps_stack_t *st,	// I - Stack
 static void
 ppd_delete_stack(_ppd_ps_stack_t *st)	// I - Stack
 {
-  free(st->objs);
-  free(st);
+  if (st->objs != st->buffer)
+    free(st->objs);
 }
 
 
@@ -1025,42 +1169,480 @@ ppd_error_stack(_ppd_ps_stack_t *st,	// I - Stack
 
 
 //
-// 'ppd_index_stack()' - Copy the Nth value on the stack.
-//
-
-static _ppd_ps_obj_t	*		// O - New object
-ppd_index_stack(_ppd_ps_stack_t *st,	// I - Stack
-            int              n)		// I - Object index
-{
-  if (n < 0 || (n = st->num_objs - n - 1) < 0)
-    return (NULL);
-
-  return (ppd_push_stack(st, st->objs + n));
-}
-
-
+// 'ppd_exec_choices()' - Apply the code of the marked choices of a section.
 //
-// 'ppd_new_stack()' - Create a new stack.
+// This is equivalent to running the output of ppdEmitString() through
+// ppdRasterExecPS(), but uses the compiled code of the choices.  Custom
+// choices get their code generated from the current parameter values, so
+// sections with custom choices are interpreted the classic way.
 //
 
-static _ppd_ps_stack_t	*		// O - New stack
-ppd_new_stack(void)
+static int				// O - 0 on success, -1 on error
+ppd_exec_choices(
+    cups_page_header_t *h,		// O - Page header
+    int                *preferred_bits,	// O - Preferred bits per color
+    ppd_file_t         *ppd,		// I - PPD file
+    ppd_section_t      section)		// I - Section to apply
 {
-  _ppd_ps_stack_t	*st;		// New stack
+  int			i,		// Looping var
+			count,		// Number of choices
+			status = 0;	// Return status
+  ppd_choice_t		**choices;	// Marked choices of the section
+  _ppd_ps_code_t	**codes;	// Compiled code of the choices
+  char			*code;		// Code to interpret
 
 
-  if ((st = calloc(1, sizeof(_ppd_ps_stack_t))) == NULL)
-    return (NULL);
+  //
+  // Collect the choices the same way as ppdEmitString() does...
+  //
 
-  st->alloc_objs = 32;
+  ppdHandleMedia(ppd);
+
+  if ((count = ppdCollect2(ppd, section, 0.0, &choices)) == 0)
+    return (0);
 
-  if ((st->objs = calloc(32, sizeof(_ppd_ps_obj_t))) == NULL)
+  if ((codes = calloc((size_t)count, sizeof(_ppd_ps_code_t *))) == NULL)
   {
-    free(st);
-    return (NULL);
+    free(choices);
+    return (-1);
+  }
+
+  for (i = 0; i < count; i ++)
+  {
+    if (!_ppd_strcasecmp(choices[i]->choice, "Custom"))
+      break;
+
+    if (!choices[i]->code || !choices[i]->code[0])
+      continue;
+
+    if ((codes[i] = ppd_compile_code(ppd, choices[i]->code, 1)) == NULL ||
+        codes[i]->status)
+      break;
+  }
+
+  if (i < count)
+  {
+    //
+    // Interpret the code of the whole section...
+    //
+
+    if ((code = ppdEmitString(ppd, section, 0.0)) != NULL)
+    {
+      status = ppdRasterExecPS(h, preferred_bits, code);
+      free(code);
+    }
   }
   else
-    return (st);
+  {
+    for (i = 0; i < count; i ++)
+      if (codes[i])
+        ppd_exec_code(h, preferred_bits, codes[i]);
+  }
+
+  free(codes);
+  free(choices);
+
+  return (status);
+}
+
+
+//
+// 'ppd_exec_code()' - Apply compiled code to a page header.
+//
+
+static void
+ppd_exec_code(
+    cups_page_header_t *h,		// O - Page header
+    int                *preferred_bits,	// O - Preferred bits per color
+    _ppd_ps_code_t     *c)		// I - Compiled code
+{
+  int			i,		// Looping var
+			start;		// Start of current dictionary
+  _ppd_ps_stack_t	st;		// Stack with one dictionary
+
+
+  for (i = 0, start = 0; i < c->num_objs; i ++)
+  {
+    if (c->objs[i].type != PPD_PS_END_DICT)
+      continue;
+
+    ppd_init_stack(&st, c->objs + start, i - start + 1);
+    st.num_objs = st.alloc_objs;
+
+    ppd_setpagedevice(&st, h, preferred_bits);
+
+    start = i + 1;
+  }
+}
+
+
+//
+// 'ppd_exec_ps()' - Execute PostScript code, optionally recording the
+//                   dictionaries passed to setpagedevice.
+//
+
+static int				// O - 0 on success, -1 on error
+ppd_exec_ps(
+    cups_page_header_t *h,		// O - Page header
+    int                 *preferred_bits,// O - Preferred bits per color
+    const char          *code,		// I - PS code to execute
+    _ppd_ps_code_t      *record)	// I - Compiled code to record to or
+					//     @code NULL@ for none
+{
+  int			error = 0;	// Error condition?
+  _ppd_ps_stack_t	stack,		// PostScript value stack
+			*st = &stack;	// Pointer to stack
+  _ppd_ps_obj_t		objs[PPD_PS_STACK_SIZE],
+					// Initial storage of stack
+			*obj;		// Object from top of stack
+  const char		*codeptr;	// Pointer into code
+
+
+  DEBUG_printf(("ppd_exec_ps(h=%p, preferred_bits=%p, code=\"%s\", record=%p)\n",
+                h, preferred_bits, code, record));
+
+  //
+  // Create a stack, only deeper stacks need memory from the heap...
+  //
+
+  ppd_init_stack(st, objs, PPD_PS_STACK_SIZE);
+
+  //
+  // Parse the PS string until we run out of data...
+  //
+
+  codeptr = code;
+
+  while ((obj = ppd_scan_ps(st, &codeptr)) != NULL)
+  {
+#ifdef DEBUG
+    DEBUG_printf(("ppd_exec_ps: Stack (%d objects)", st->num_objs));
+    ppd_DEBUG_object("ppd_exec_ps", obj);
+#endif // DEBUG
+
+    switch (obj->type)
+    {
+      default :
+          // Do nothing for regular values
+	  break;
+
+      case PPD_PS_CLEARTOMARK :
+          ppd_pop_stack(st);
+
+	  if (ppd_cleartomark_stack(st))
+	    _ppdRasterAddError("cleartomark: Stack underflow.\n");
+
+#ifdef DEBUG
+          DEBUG_puts("1ppd_exec_ps:    dup");
+	  ppd_DEBUG_stack("ppd_exec_ps", st);
+#endif // DEBUG
+          break;
+
+      case PPD_PS_COPY :
+          ppd_pop_stack(st);
+	  if ((obj = ppd_pop_stack(st)) != NULL)
+	  {
+	    ppd_copy_stack(st, (int)obj->value.number);
+
+#ifdef DEBUG
+            DEBUG_puts("ppd_exec_ps: copy");
+	    ppd_DEBUG_stack("ppd_exec_ps", st);
+#endif // DEBUG
+          }
+          break;
+
+      case PPD_PS_DUP :
+          ppd_pop_stack(st);
+	  ppd_copy_stack(st, 1);
+
+#ifdef DEBUG
+          DEBUG_puts("ppd_exec_ps: dup");
+	  ppd_DEBUG_stack("ppd_exec_ps", st);
+#endif // DEBUG
+          break;
+
+      case PPD_PS_INDEX :
+          ppd_pop_stack(st);
+	  if ((obj = ppd_pop_stack(st)) != NULL)
+	  {
+	    ppd_index_stack(st, (int)obj->value.number);
+
+#ifdef DEBUG
+            DEBUG_puts("ppd_exec_ps: index");
+	    ppd_DEBUG_stack("ppd_exec_ps", st);
+#endif // DEBUG
+          }
+          break;
+
+      case PPD_PS_POP :
+          ppd_pop_stack(st);
+          ppd_pop_stack(st);
+
+#ifdef DEBUG
+          DEBUG_puts("ppd_exec_ps: pop");
+	  ppd_DEBUG_stack("ppd_exec_ps", st);
+#endif // DEBUG
+          break;
+
+      case PPD_PS_ROLL :
+          ppd_pop_stack(st);
+	  if ((obj = ppd_pop_stack(st)) != NULL)
+	  {
+            int		c;		// Count
+
+
+            c = (int)obj->value.number;
+
+	    if ((obj = ppd_pop_stack(st)) != NULL)
+	    {
+	      ppd_roll_stack(st, (int)obj->value.number, c);
+
+#ifdef DEBUG
+              DEBUG_puts("ppd_exec_ps: roll");
+	      ppd_DEBUG_stack("ppd_exec_ps", st);
+#endif // DEBUG
+            }
+	  }
+          break;
+
+      case PPD_PS_SETPAGEDEVICE :
+          ppd_pop_stack(st);
+	  if (record && ppd_record_dict(st, record))
+	    record->status = -1;
+	  ppd_setpagedevice(st, h, preferred_bits);
+
+#ifdef DEBUG
+          DEBUG_puts("ppd_exec_ps: setpagedevice");
+	  ppd_DEBUG_stack("ppd_exec_ps", st);
+#endif // DEBUG
+          break;
+
+      case PPD_PS_START_PROC :
+      case PPD_PS_END_PROC :
+      case PPD_PS_STOPPED :
+          ppd_pop_stack(st);
+	  break;
+
+      case PPD_PS_OTHER :
+          _ppdRasterAddError("Unknown operator \"%s\".\n", obj->value.other);
+	  error = 1;
+          DEBUG_printf(("ppd_exec_ps: Unknown operator \"%s\".", obj->value.other));
+          break;
+    }
+
+    if (error)
+      break;
+  }
+
+  //
+  // Cleanup...
+  //
+
+  if (st->num_objs > 0)
+  {
+    ppd_error_stack(st, "Stack not empty:");
+
+#ifdef DEBUG
+    DEBUG_puts("ppd_exec_ps: Stack not empty");
+    ppd_DEBUG_stack("ppd_exec_ps", st);
+#endif // DEBUG
+
+    ppd_delete_stack(st);
+
+    return (-1);
+  }
+
+  ppd_delete_stack(st);
+
+  //
+  // Return success...
+  //
+
+  return (0);
+}
+
+
+//
+// 'ppd_grow_stack()' - Make room for more objects on the stack.
+//
+// The storage is doubled in size each time, so the objects move to the
+// heap only once for all but very deep stacks.
+//
+
+static int				// O - 0 on success, -1 on error
+ppd_grow_stack(_ppd_ps_stack_t *st,	// I - Stack
+               int             count)	// I - Number of objects to add
+{
+  int		alloc_objs;		// New number of allocated objects
+  _ppd_ps_obj_t	*temp;			// New objects
+
+
+  for (alloc_objs = st->alloc_objs > 0 ? st->alloc_objs : 32;
+       alloc_objs < st->num_objs + count;
+       alloc_objs *= 2);
+
+  if (st->objs == st->buffer)
+  {
+    if ((temp = malloc((size_t)alloc_objs * sizeof(_ppd_ps_obj_t))) == NULL)
+      return (-1);
+
+    memcpy(temp, st->objs, (size_t)st->num_objs * sizeof(_ppd_ps_obj_t));
+  }
+  else if ((temp = realloc(st->objs, (size_t)alloc_objs *
+                                     sizeof(_ppd_ps_obj_t))) == NULL)
+    return (-1);
+
+  st->objs       = temp;
+  st->alloc_objs = alloc_objs;
+
+  return (0);
+}
+
+
+//
+// 'ppd_index_stack()' - Copy the Nth value on the stack.
+//
+
+static _ppd_ps_obj_t	*		// O - New object
+ppd_index_stack(_ppd_ps_stack_t *st,	// I - Stack
+            int              n)		// I - Object index
+{
+  if (n < 0 || (n = st->num_objs - n - 1) < 0)
+    return (NULL);
+
+  return (ppd_push_stack(st, st->objs + n));
+}
+
+
+//
+// 'ppd_init_stack()' - Initialize a stack.
+//
+
+static void
+ppd_init_stack(_ppd_ps_stack_t *st,	// I - Stack
+               _ppd_ps_obj_t   *buffer,	// I - Initial storage for objects
+	       int             count)	// I - Number of objects in storage
+{
+  st->num_objs   = 0;
+  st->alloc_objs = count;
+  st->objs       = buffer;
+  st->buffer     = buffer;
+}
+
+
+//
+// 'ppd_memo_add()' - Remember the page header for a set of marked choices.
+//
+// The key is owned by the PPD afterwards, the least recently used page
+// header gets dropped if there are too many.
+//
+
+static void
+ppd_memo_add(ppd_file_t         *ppd,	// I - PPD file
+             _ppd_header_memo_t *key,	// I - Marked choices
+             cups_page_header_t *h,	// I - Page header
+	     int                preferred_bits)
+					// I - Preferred bits per color
+{
+  _ppd_header_memo_t	*oldest;	// Least recently used page header
+
+
+  if (!ppd->raster_headers &&
+      (ppd->raster_headers = cupsArrayNew(NULL, NULL, NULL, 0, NULL,
+                                          NULL)) == NULL)
+  {
+    free(key);
+    return;
+  }
+
+  if (cupsArrayGetCount(ppd->raster_headers) >= PPD_MAX_HEADER_MEMO)
+  {
+    oldest = (_ppd_header_memo_t *)cupsArrayGetLast(ppd->raster_headers);
+    cupsArrayRemove(ppd->raster_headers, oldest);
+    free(oldest);
+  }
+
+  memcpy(&key->header, h, sizeof(cups_page_header_t));
+  key->preferred_bits = preferred_bits;
+
+  cupsArrayInsert(ppd->raster_headers, key);
+}
+
+
+//
+// 'ppd_memo_find()' - Find the page header for a set of marked choices.
+//
+// Page headers are kept in the order of their last use, so a found page
+// header gets moved to the front.
+//
+
+static _ppd_header_memo_t *		// O - Page header or NULL
+ppd_memo_find(ppd_file_t         *ppd,	// I - PPD file
+              _ppd_header_memo_t *key)	// I - Marked choices
+{
+  _ppd_header_memo_t	*memo;		// Current page header
+
+
+  for (memo = (_ppd_header_memo_t *)cupsArrayGetFirst(ppd->raster_headers);
+       memo;
+       memo = (_ppd_header_memo_t *)cupsArrayGetNext(ppd->raster_headers))
+  {
+    if (memo->hash == key->hash && memo->num_marked == key->num_marked &&
+        !memcmp(memo->marked, key->marked,
+	        (size_t)key->num_marked * sizeof(ppd_choice_t *)))
+    {
+      cupsArrayRemove(ppd->raster_headers, memo);
+      cupsArrayInsert(ppd->raster_headers, memo);
+
+      return (memo);
+    }
+  }
+
+  return (NULL);
+}
+
+
+//
+// 'ppd_memo_new()' - Create a page header key from the marked choices.
+//
+// Custom choices get their code generated from the current parameter
+// values, so no key is created if any custom choice is marked.
+//
+
+static _ppd_header_memo_t *		// O - Key or NULL
+ppd_memo_new(ppd_file_t *ppd)		// I - PPD file
+{
+  _ppd_header_memo_t	*key;		// Key
+  ppd_choice_t		*c;		// Current marked choice
+  int			count;		// Number of marked choices
+  unsigned long long	hash = _PPD_HASH_INIT;
+					// Hash of marked choices (FNV-1a)
+
+
+  count = cupsArrayGetCount(ppd->marked);
+
+  if ((key = calloc(1, sizeof(_ppd_header_memo_t) +
+                       (size_t)count * sizeof(ppd_choice_t *))) == NULL)
+    return (NULL);
+
+  for (c = (ppd_choice_t *)cupsArrayGetFirst(ppd->marked);
+       c && key->num_marked < count;
+       c = (ppd_choice_t *)cupsArrayGetNext(ppd->marked))
+  {
+    if (!_ppd_strcasecmp(c->choice, "Custom"))
+    {
+      free(key);
+      return (NULL);
+    }
+
+    key->marked[key->num_marked ++] = c;
+
+    hash = _ppdHashBytes(hash, &c, sizeof(c));
+  }
+
+  key->hash = (unsigned)(hash ^ (hash >> 32));
+
+  return (key);
 }
 
 
@@ -1091,18 +1673,24 @@ ppd_push_stack(_ppd_ps_stack_t *st,	// I - Stack
            _ppd_ps_obj_t   *obj)	// I - Object
 {
   _ppd_ps_obj_t	*temp;		// New object
+  ptrdiff_t	n = -1;			// Index of object on stack
 
 
   if (st->num_objs >= st->alloc_objs)
   {
-    st->alloc_objs += 32;
+    //
+    // The object may be one on the stack itself (index), so find it again
+    // after growing the stack...
+    //
+
+    if (obj >= st->objs && obj < st->objs + st->num_objs)
+      n = obj - st->objs;
 
-    if ((temp = realloc(st->objs, (size_t)st->alloc_objs *
-                                  sizeof(_ppd_ps_obj_t))) == NULL)
+    if (ppd_grow_stack(st, 1))
       return (NULL);
 
-    st->objs = temp;
-    memset(temp + st->num_objs, 0, 32 * sizeof(_ppd_ps_obj_t));
+    if (n >= 0)
+      obj = st->objs + n;
   }
 
   temp = st->objs + st->num_objs;
@@ -1114,6 +1702,67 @@ ppd_push_stack(_ppd_ps_stack_t *st,	// I - Stack
 }
 
 
+//
+// 'ppd_record_dict()' - Record the dictionary on top of the stack which is
+//                       about to get passed to setpagedevice.
+//
+
+static int				// O - 0 on success, -1 on error
+ppd_record_dict(_ppd_ps_stack_t *st,	// I - Stack
+                _ppd_ps_code_t  *record)// I - Compiled code
+{
+  _ppd_ps_obj_t	*obj,			// Start of dictionary
+		*end,			// End of dictionary
+		*temp;			// New objects
+  int		count;			// Number of objects in dictionary
+
+
+  //
+  // Find the dictionary the same way as ppd_setpagedevice() does...
+  //
+
+  if (st->num_objs == 0)
+    return (0);
+
+  obj = end = st->objs + st->num_objs - 1;
+
+  if (obj->type != PPD_PS_END_DICT)
+    return (0);
+
+  for (obj --; obj > st->objs; obj --)
+    if (obj->type == PPD_PS_START_DICT)
+      break;
+
+  count = (int)(end - obj) + 1;
+
+  //
+  // Nested dictionaries cannot be split up again when applying the compiled
+  // code, so don't record them...
+  //
+
+  for (temp = obj; temp < end; temp ++)
+    if (temp->type == PPD_PS_END_DICT)
+      return (-1);
+
+  if (record->num_objs + count > record->alloc_objs)
+  {
+    record->alloc_objs = record->num_objs + count + 32;
+
+    if ((temp = realloc(record->objs, (size_t)record->alloc_objs *
+                                      sizeof(_ppd_ps_obj_t))) == NULL)
+      return (-1);
+
+    record->objs = temp;
+  }
+
+  memcpy(record->objs + record->num_objs, obj,
+         (size_t)count * sizeof(_ppd_ps_obj_t));
+  record->num_objs += count;
+
+  return (0);
+}
+
+
 //
 // 'ppd_roll_stack()' - Rotate stack objects.
 //
@@ -1193,11 +1842,12 @@ ppd_roll_stack(_ppd_ps_stack_t *st,	// I - Stack
 
 static _ppd_ps_obj_t *			// O  - New object or NULL on EOF
 ppd_scan_ps(_ppd_ps_stack_t  *st,	// I  - Stack
-	    char             **ptr)	// IO - String pointer
+	    const char       **ptr)	// IO - String pointer
 {
   _ppd_ps_obj_t		obj;		// Current object
-  char			*start,		// Start of object
-			*cur,		// Current position
+  const char		*start,		// Start of object
+			*cur;		// Current position
+  char			*numend,	// End of number
 			*valptr,	// Pointer into value string
 			*valend;	// End of value string
   int			parens;		// Parenthesis nesting level
@@ -1460,7 +2110,8 @@ ppd_scan_ps(_ppd_ps_stack_t  *st,	// I  - Stack
 	  // Integer with radix...
 	  //
 
-          obj.value.number = strtol(cur + 1, &cur, atoi(start));
+          obj.value.number = strtol(cur + 1, &numend, atoi(start));
+	  cur              = numend;
 	  break;
 	}
 	else if (strchr(".Ee()<>[]{}/%", *cur) || isspace(*cur & 255))
@@ -1469,7 +2120,8 @@ ppd_scan_ps(_ppd_ps_stack_t  *st,	// I  - Stack
 	  // Integer or real number...
 	  //
 
-	  obj.value.number = _ppdStrScand(start, &cur, localeconv());
+	  obj.value.number = _ppdStrScand(start, &numend, localeconv());
+	  cur              = numend;
           break;
 	}
 	else
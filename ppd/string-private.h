@@ -180,6 +180,18 @@ extern int	_ppd_vsnprintf(char *, size_t, const char *, va_list);
 #  endif // !HAVE_VSNPRINTF
 
 
+//
+// Hash functions...
+//
+
+#  define _PPD_HASH_INIT 14695981039346656037ULL
+					// Initial value for _ppdHashBytes()
+
+extern unsigned long long _ppdHashBytes(unsigned long long hash,
+					const void *data, size_t len);
+extern unsigned	_ppdHashString(const char *s, int nocase);
+
+
 //
 // String pool functions...
 //
@@ -22,6 +22,14 @@
 #include <limits.h>
 
 
+//
+// Constants...
+//
+
+#define PPD_HASH_PRIME	1099511628211ULL
+					// Prime of the 64-bit FNV-1a hash
+
+
 //
 // Local globals...
 //
@@ -39,6 +47,55 @@ static cups_array_t	*stringpool = NULL;
 static int	ppd_compare_sp_items(_ppd_sp_item_t *a, _ppd_sp_item_t *b);
 
 
+//
+// '_ppdHashBytes()' - Add bytes to a 64-bit FNV-1a hash.
+//
+// Start with @code _PPD_HASH_INIT@ and pass the result of each call to the
+// next one to hash several values.
+//
+
+unsigned long long			// O - New hash value
+_ppdHashBytes(unsigned long long hash,	// I - Current hash value
+              const void         *data,	// I - Data
+	      size_t             len)	// I - Length of data
+{
+  const unsigned char	*ptr;		// Pointer into data
+
+
+  for (ptr = (const unsigned char *)data; len > 0; len --, ptr ++)
+    hash = (hash ^ *ptr) * PPD_HASH_PRIME;
+
+  return (hash);
+}
+
+
+//
+// '_ppdHashString()' - Compute the hash of a string.
+//
+// The 64-bit FNV-1a hash of the string is folded into an unsigned value,
+// suitable as a key or for the hash callbacks of cupsArrayNew().
+//
+
+unsigned				// O - Hash value
+_ppdHashString(const char *s,		// I - String
+               int        nocase)	// I - Ignore case of ASCII letters?
+{
+  unsigned long long	hash = _PPD_HASH_INIT;
+					// FNV-1a hash
+
+
+  if (nocase)
+  {
+    for (; *s; s ++)
+      hash = (hash ^ (unsigned char)_ppd_tolower(*s)) * PPD_HASH_PRIME;
+  }
+  else
+    hash = _ppdHashBytes(hash, s, strlen(s));
+
+  return ((unsigned)(hash ^ (hash >> 32)));
+}
+
+
 //
 // '_ppdStrAlloc()' - Allocate/reference a string.
 //
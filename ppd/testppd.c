@@ -14,6 +14,7 @@
 
 #include <ppd/ppd.h>
 #include <ppd/array-private.h>
+#include <ppd/ipp-private.h>
 #include <ppd/raster-private.h>
 #include <ppd/libcups2-private.h>
 #include <sys/stat.h>
@@ -30,10 +31,19 @@
 // Local functions...
 //
 
+static int	do_case_tests(void);
+static int	do_generator_tests(void);
 static int	do_ppd_tests(const char *filename, int num_options,
 			     cups_option_t *options);
 static int	do_ps_tests(void);
+static int	do_raster_tests(void);
+static int	do_test_files_tests(void);
+static int	interpret_ppd(ppd_file_t *ppd, const char *options,
+			      cups_page_header_t *header);
 static void	print_changes(cups_page_header_t *header, cups_page_header_t *expected);
+static int	same_contents(const char *filename1, const char *filename2);
+static int	same_report(cups_array_t *report, int result,
+			    cups_array_t *expected, int expected_result);
 
 
 //
@@ -206,13 +216,13 @@ static const char	*default_code =
 			"%%EndFeature\n"
 			"} stopped cleartomark\n"
 			"[{\n"
-			"%%BeginFeature: *OutputBin Tray1\n"
-			"OutputBin=Tray1\n"
+			"%%BeginFeature: *MediaType Plain\n"
+			"MediaType=Plain\n"
 			"%%EndFeature\n"
 			"} stopped cleartomark\n"
 			"[{\n"
-			"%%BeginFeature: *MediaType Plain\n"
-			"MediaType=Plain\n"
+			"%%BeginFeature: *OutputBin Tray1\n"
+			"OutputBin=Tray1\n"
 			"%%EndFeature\n"
 			"} stopped cleartomark\n"
 			"[{\n"
@@ -572,6 +582,77 @@ main(int  argc,				// I - Number of command-line arguments
     if (s)
       free(s);
 
+    //
+    // Options with the same OrderDependency value are collected by keyword,
+    // the custom page size at its NonUIOrderDependency value...
+    //
+
+    {
+      static const char * const collect_any[] =
+      {					// Marked AnySetup choices in order
+        "InstalledDuplexer False",	// 10
+	"InputSlot Tray",		// 20
+	"MediaType Plain",		// 25
+	"OutputBin Tray1",		// 25
+	"IntOption None",		// 30
+	"StringOption Custom",		// 40
+	"PageSize Custom"		// 100 (NonUIOrderDependency)
+      };
+      static const struct
+      {
+        float	min_order;		// Minimum order
+	int	first;			// First expected choice
+      }			collect_tests[] =
+      {					// ppdCollect2() tests
+        { 0.0f, 0 },
+	{ 25.0f, 2 },
+	{ 26.0f, 4 },
+	{ 100.0f, 6 },
+	{ 101.0f, 7 }
+      };
+      int		j,		// Looping var
+			count,		// Number of choices
+			expected;	// Expected number of choices
+      ppd_choice_t	**choices;	// Collected choices
+
+
+      for (i = 0; i < (int)(sizeof(collect_tests) / sizeof(collect_tests[0]));
+           i ++)
+      {
+	printf("ppdCollect2(AnySetup, %g): ", collect_tests[i].min_order);
+
+	count    = ppdCollect2(ppd, PPD_ORDER_ANY, collect_tests[i].min_order,
+	                       &choices);
+	expected = (int)(sizeof(collect_any) / sizeof(collect_any[0])) -
+	           collect_tests[i].first;
+
+	for (j = 0; j < count && j < expected; j ++)
+	{
+	  snprintf(buffer, sizeof(buffer), "%s %s",
+	           choices[j]->option->keyword, choices[j]->choice);
+
+	  if (strcmp(buffer, collect_any[collect_tests[i].first + j]))
+	    break;
+	}
+
+	if (count != expected)
+	{
+	  status ++;
+	  printf("FAIL (%d choices instead of %d)\n", count, expected);
+	}
+	else if (j < count)
+	{
+	  status ++;
+	  printf("FAIL (\"%s\" instead of \"%s\")\n", buffer,
+	         collect_any[collect_tests[i].first + j]);
+	}
+	else
+	  puts("PASS");
+
+	free(choices);
+      }
+    }
+
     //
     // Test constraints...
     //
@@ -905,6 +986,94 @@ main(int  argc,				// I - Number of command-line arguments
              text ? text : "(null)");
     }
 
+    fputs("ppdLocalizeText(fr PageSize): ", stdout);
+    if ((text = ppdLocalizeText(ppd, "PageSize", NULL)) != NULL &&
+        !strcmp(text, "French Page Size"))
+      puts("PASS");
+    else
+    {
+      status ++;
+      printf("FAIL (\"%s\" instead of \"French Page Size\")\n",
+             text ? text : "(null)");
+    }
+
+    fputs("ppdLocalizeText(fr PageSize A4): ", stdout);
+    if ((text = ppdLocalizeText(ppd, "PageSize", "A4")) != NULL &&
+        !strcmp(text, "French A4"))
+      puts("PASS");
+    else
+    {
+      status ++;
+      printf("FAIL (\"%s\" instead of \"French A4\")\n",
+             text ? text : "(null)");
+    }
+
+    //
+    // Load only the French localizations...
+    //
+
+    for (i = 0; i < 2; i ++)
+    {
+      ppd_file_t	*frppd;		// PPD file with French localizations
+
+
+      if (i == 0)
+      {
+        cups_file_t	*fp;		// PPD file
+
+
+        fputs("ppdOpenWithLocale(fr): ", stdout);
+
+        if ((fp = cupsFileOpen("ppd/test.ppd", "r")) != NULL)
+	{
+	  frppd = ppdOpenWithLocale(fp, "fr");
+	  cupsFileClose(fp);
+	}
+	else
+	  frppd = NULL;
+      }
+      else
+      {
+        fputs("ppdOpenFileWithLocale(fr): ", stdout);
+
+        frppd = ppdOpenFileWithLocale("ppd/test.ppd", "fr");
+      }
+
+      if (!frppd)
+      {
+        status ++;
+	puts("FAIL (unable to open)");
+      }
+      else if ((attr = ppdFindAttr(frppd, "fr.Translation",
+                                   "PageSize")) == NULL ||
+               strcmp(attr->text, "French Page Size"))
+      {
+        status ++;
+	printf("FAIL (fr.Translation PageSize \"%s\")\n",
+	       attr ? attr->text : "(null)");
+      }
+      else if (!ppdFindAttr(frppd, "fr.cupsMarkerName", "cyan"))
+      {
+        status ++;
+	puts("FAIL (fr.cupsMarkerName cyan not loaded)");
+      }
+      else if (ppdFindAttr(frppd, "fr_CA.Translation", "PageSize"))
+      {
+        status ++;
+	puts("FAIL (fr_CA.Translation PageSize loaded)");
+      }
+      else if (ppdFindAttr(frppd, "zh_TW.cupsMarkerName", "cyan") ||
+               ppdFindAttr(frppd, "zh_TW.cupsIPPReason", "foo"))
+      {
+        status ++;
+	puts("FAIL (zh_TW localizations loaded)");
+      }
+      else
+        puts("PASS");
+
+      ppdClose(frppd);
+    }
+
     // Force Simplified Chinese locale
     putenv("LANG=zh_TW");
     putenv("LC_ALL=zh_TW");
@@ -1163,6 +1332,10 @@ main(int  argc,				// I - Number of command-line arguments
     }
 
     status += do_ps_tests();
+    status += do_raster_tests();
+    status += do_generator_tests();
+    status += do_case_tests();
+    status += do_test_files_tests();
   }
   else if (!strcmp(argv[1], "--raster"))
   {
@@ -1571,6 +1744,226 @@ main(int  argc,				// I - Number of command-line arguments
 }
 
 
+//
+// 'do_case_tests()' - Test the name checks of ppdTest().
+//
+// test5.ppd has groups, options, and choices whose names only differ by
+// case, and options whose names start with the name of another option.
+// The lines reporting them must be the same as those of the original
+// pairwise checks, in the same order.
+//
+
+static int				// O - Number of errors
+do_case_tests(void)
+{
+  int		i,			// Looping var
+		errors = 0;		// Number of errors
+  cups_array_t	*files,			// PPD file to test
+		*report = NULL;		// Report of ppdTest()
+  const char	*line;			// Report line
+  static const char * const expected[] =
+  {					// Expected report lines
+    "      **FAIL**  Group names Extra and EXTRA differ only by case.",
+    "      **FAIL**  Group names Extra and extra differ only by case.",
+    "      **FAIL**  Group names EXTRA and extra differ only by case.",
+    "      **FAIL**  Option names Foo and FOO differ only by case.",
+    "      **FAIL**  Option names Foo and foo differ only by case.",
+    "      **FAIL**  Option Foo choice names A and a differ only by case.",
+    "      **FAIL**  Multiple occurrences of option Foo choice name A.",
+    "      **FAIL**  Option names FOO and foo differ only by case.",
+    "      **FAIL**  Option FooBar choice names Tray and TRAY differ only "
+        "by case.",
+    "      **FAIL**  Option FooBar choice names Tray and tray differ only "
+        "by case.",
+    "      **FAIL**  Option FooBar choice names TRAY and tray differ only "
+        "by case.",
+    "        WARN    Foo shares a common prefix with FooBar\n"
+    "                REF: Page 15, section 3.2.",
+    "        WARN    Fo shares a common prefix with Foo\n"
+    "                REF: Page 15, section 3.2.",
+    "        WARN    Fo shares a common prefix with FooBar\n"
+    "                REF: Page 15, section 3.2."
+  };
+
+
+  fputs("ppdTest(names differing by case): ", stdout);
+
+  files = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+  cupsArrayAdd(files, "ppd/test5.ppd");
+
+  ppdTest(0, 0, NULL, 1, 0, 0, files, &report, NULL, NULL);
+
+  for (i = 0, line = (const char *)cupsArrayGetFirst(report);
+       line;
+       line = (const char *)cupsArrayGetNext(report))
+  {
+    if (!strstr(line, "differ only by case") &&
+        !strstr(line, "Multiple occurrences") &&
+        !strstr(line, "shares a common prefix"))
+      continue;
+
+    if (i >= (int)(sizeof(expected) / sizeof(expected[0])))
+    {
+      printf("FAIL (unexpected \"%s\")\n", line);
+      errors ++;
+      break;
+    }
+    else if (strcmp(line, expected[i]))
+    {
+      printf("FAIL (\"%s\" instead of \"%s\")\n", line, expected[i]);
+      errors ++;
+      break;
+    }
+
+    i ++;
+  }
+
+  if (!errors && i < (int)(sizeof(expected) / sizeof(expected[0])))
+  {
+    printf("FAIL (missing \"%s\")\n", expected[i]);
+    errors ++;
+  }
+  else if (!errors)
+    puts("PASS");
+
+  cupsArrayDelete(report);
+  cupsArrayDelete(files);
+
+  return (errors);
+}
+
+
+//
+// 'do_generator_tests()' - Test the cache of generated PPD files.
+//
+
+static int				// O - Number of errors
+do_generator_tests(void)
+{
+  int			i;		// Looping var
+  ipp_t			*ipp;		// Printer attributes
+  ipp_attribute_t	*media,		// media-supported
+			*state,		// printer-state
+			*uptime;	// printer-up-time
+  char			first[1024],	// First PPD file
+			filename[1024];	// Current PPD file
+  unsigned		hits;		// Copies of generated PPD files
+  int			errors = 0;	// Number of errors
+  static const char * const formats[] =	// document-format-supported
+  {
+    "application/octet-stream",
+    "application/pdf",
+    "image/jpeg"
+  };
+  static const char * const sizes[] =	// media-supported
+  {
+    "na_letter_8.5x11in",
+    "iso_a4_210x297mm"
+  };
+  static const char * const names[] =	// Names of tests
+  {
+    "same attributes",
+    "new printer-state and printer-up-time",
+    "new media-supported"
+  };
+
+
+  ipp = ippNew();
+
+  ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-make-and-model",
+               NULL, "Example Printer");
+  ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_MIMETYPE,
+                "document-format-supported",
+		(int)(sizeof(formats) / sizeof(formats[0])), NULL, formats);
+  media = ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_KEYWORD,
+                        "media-supported",
+			(int)(sizeof(sizes) / sizeof(sizes[0])), NULL, sizes);
+  ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-default", NULL,
+               sizes[0]);
+  state  = ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_ENUM, "printer-state",
+                         IPP_PSTATE_IDLE);
+  uptime = ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER,
+                         "printer-up-time", 1000);
+
+  fputs("ppdCreatePPDFromIPP(first): ", stdout);
+  fflush(stdout);
+
+  if (!ppdCreatePPDFromIPP(first, sizeof(first), ipp, NULL, NULL, 0, 0, NULL,
+                           0))
+  {
+    puts("FAIL (no PPD file)");
+    ippDelete(ipp);
+    return (1);
+  }
+
+  puts("PASS");
+
+  //
+  // The same capabilities get a new copy of the same PPD file, status
+  // attributes are not part of the cache key...
+  //
+
+  for (i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i ++)
+  {
+    printf("ppdCreatePPDFromIPP(%s): ", names[i]);
+    fflush(stdout);
+
+    if (i == 1)
+    {
+      ippSetInteger(ipp, &state, 0, IPP_PSTATE_PROCESSING);
+      ippSetInteger(ipp, &uptime, 0, 2000);
+    }
+    else if (i == 2)
+      ippSetString(ipp, &media, 1, "iso_a5_148x210mm");
+
+    hits = _ppdGeneratedHits();
+
+    if (!ppdCreatePPDFromIPP(filename, sizeof(filename), ipp, NULL, NULL, 0,
+                             0, NULL, 0))
+    {
+      puts("FAIL (no PPD file)");
+      errors ++;
+      continue;
+    }
+
+    if (!strcmp(filename, first))
+    {
+      puts("FAIL (same filename)");
+      errors ++;
+    }
+    else if (i < 2 && _ppdGeneratedHits() != hits + 1)
+    {
+      puts("FAIL (PPD file generated again)");
+      errors ++;
+    }
+    else if (i < 2 && !same_contents(filename, first))
+    {
+      puts("FAIL (different contents)");
+      errors ++;
+    }
+    else if (i == 2 && _ppdGeneratedHits() != hits)
+    {
+      puts("FAIL (PPD file copied)");
+      errors ++;
+    }
+    else if (i == 2 && same_contents(filename, first))
+    {
+      puts("FAIL (same contents)");
+      errors ++;
+    }
+    else
+      puts("PASS");
+
+    unlink(filename);
+  }
+
+  unlink(first);
+  ippDelete(ipp);
+
+  return (errors);
+}
+
+
 //
 // 'do_ppd_tests()' - Test the default option commands in a PPD file.
 //
@@ -1627,6 +2020,7 @@ do_ppd_tests(const char    *filename,	// I - PPD file
 static int
 do_ps_tests(void)
 {
+  int			i;		// Looping var
   cups_page_header_t	header;		// Page header
   int			preferred_bits;	// Preferred bits
   int			errors = 0;	// Number of errors
@@ -1742,10 +2136,267 @@ do_ps_tests(void)
   else
     puts("PASS");
 
+  //
+  // Run the same code on different page headers, the second time around
+  // the results of earlier calls are used...
+  //
+
+  fputs("ppdRasterExecPS(remembered calls): ", stdout);
+  fflush(stdout);
+
+  for (i = 0; i < 12; i ++)
+  {
+    memset(&header, 0, sizeof(header));
+    header.HWResolution[0] = 100 * (unsigned)(i % 3 + 1);
+    preferred_bits         = i % 2;
+
+    if (ppdRasterExecPS(&header, &preferred_bits,
+                        "<</Duplex true/cupsInteger1 7>>setpagedevice"))
+    {
+      puts("FAIL (error from function)");
+      puts(_ppdRasterErrorString());
+      errors ++;
+      break;
+    }
+    else if (header.HWResolution[0] != 100 * (unsigned)(i % 3 + 1) ||
+             preferred_bits != i % 2 || !header.Duplex ||
+	     header.cupsInteger[1] != 7)
+    {
+      printf("FAIL (call %d: HWResolution %u, cupsPreferredBitsPerColor %d, "
+             "Duplex %u, cupsInteger1 %u, expected %u, %d, 1, 7)\n", i + 1,
+	     header.HWResolution[0], preferred_bits, header.Duplex,
+	     header.cupsInteger[1], 100 * (unsigned)(i % 3 + 1), i % 2);
+      errors ++;
+      break;
+    }
+  }
+
+  if (i == 12)
+    puts("PASS");
+
   return (errors);
 }
 
 
+//
+// 'do_raster_tests()' - Test the page headers of ppdRasterInterpretPPD().
+//
+
+static int				// O - Number of errors
+do_raster_tests(void)
+{
+  int			i;		// Looping var
+  ppd_file_t		*ppd,		// PPD file used for all options
+			*fresh;		// PPD file used for one set of options
+  cups_page_header_t	expected[5],	// Page headers from fresh PPD files
+			header;		// Page header from ppd
+  int			errors = 0;	// Number of errors
+  static const struct
+  {
+    const char	*options;		// Options to mark
+    unsigned	xres,			// Expected HWResolution[0]
+		width,			// Expected PageSize[0]
+		integer2,		// Expected cupsInteger[2]
+		integer3;		// Expected cupsInteger[3]
+  }			tests[] =	// Tests
+  {
+    { "",				300, 612, 0, 0 },
+    { "Resolution=600dpi",		600, 612, 0, 0 },
+    { "PageSize=A4 Policies=Nested",	300, 595, 5, 0 },
+    { "IntOption=Custom.42",		300, 612, 0, 42 },
+    { "Resolution=600dpi IntOption=1",	600, 612, 0, 1 }
+  };
+
+
+  if ((ppd = ppdOpenFile("ppd/test3.ppd")) == NULL)
+  {
+    puts("ppdOpenFile(\"ppd/test3.ppd\"): FAIL");
+    return (1);
+  }
+
+  //
+  // The page header of a freshly loaded PPD file must not differ from the
+  // ones created with the compiled code and the remembered page headers
+  // of earlier calls...
+  //
+
+  for (i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i ++)
+  {
+    printf("ppdRasterInterpretPPD(\"%s\"): ", tests[i].options);
+    fflush(stdout);
+
+    if ((fresh = ppdOpenFile("ppd/test3.ppd")) == NULL)
+    {
+      puts("FAIL (bad PPD file)");
+      errors ++;
+      continue;
+    }
+
+    if (interpret_ppd(fresh, tests[i].options, expected + i))
+    {
+      puts("FAIL (error from function)");
+      puts(_ppdRasterErrorString());
+      errors ++;
+    }
+    else if (expected[i].HWResolution[0] != tests[i].xres ||
+             expected[i].PageSize[0] != tests[i].width ||
+	     expected[i].cupsInteger[2] != tests[i].integer2 ||
+	     expected[i].cupsInteger[3] != tests[i].integer3)
+    {
+      printf("FAIL (HWResolution %u, PageSize %u, cupsInteger2 %u, "
+             "cupsInteger3 %u, expected %u, %u, %u, %u)\n",
+	     expected[i].HWResolution[0], expected[i].PageSize[0],
+	     expected[i].cupsInteger[2], expected[i].cupsInteger[3],
+	     tests[i].xres, tests[i].width, tests[i].integer2,
+	     tests[i].integer3);
+      errors ++;
+    }
+    else if (interpret_ppd(ppd, tests[i].options, &header) ||
+             memcmp(&header, expected + i, sizeof(header)))
+    {
+      puts("FAIL (first call)");
+      print_changes(&header, expected + i);
+      errors ++;
+    }
+    else if (interpret_ppd(ppd, tests[i].options, &header) ||
+             memcmp(&header, expected + i, sizeof(header)))
+    {
+      puts("FAIL (second call)");
+      print_changes(&header, expected + i);
+      errors ++;
+    }
+    else
+      puts("PASS");
+
+    ppdClose(fresh);
+  }
+
+  //
+  // Switch back through the option sets, so the page headers remembered
+  // for other marked choices get used...
+  //
+
+  if (!errors)
+  {
+    fputs("ppdRasterInterpretPPD(remembered headers): ", stdout);
+    fflush(stdout);
+
+    for (i = (int)(sizeof(tests) / sizeof(tests[0])) - 1; i >= 0; i --)
+    {
+      if (interpret_ppd(ppd, tests[i].options, &header) ||
+          memcmp(&header, expected + i, sizeof(header)))
+      {
+	printf("FAIL (\"%s\")\n", tests[i].options);
+	print_changes(&header, expected + i);
+	errors ++;
+	break;
+      }
+    }
+
+    if (i < 0)
+      puts("PASS");
+  }
+
+  ppdClose(ppd);
+
+  return (errors);
+}
+
+
+//
+// 'do_test_files_tests()' - Test ppdTest() and ppdTestFiles() with several
+//                           files.
+//
+// The filesystem probes are cached for all files passed to one ppdTest()
+// call, so testing the files together must give the same report as testing
+// each file by itself.  ppdTestFiles() splits the files between its workers
+// and must give the same report again.
+//
+
+static int				// O - Number of errors
+do_test_files_tests(void)
+{
+  int		i,			// Looping var
+		errors = 0;		// Number of errors
+  cups_array_t	*files,			// PPD files to test
+		*single,		// Single file to test
+		*expected = NULL,	// Report of the single files
+		*report;		// Report of all files
+  int		expected_result = 1,	// Result of the single files
+		result;			// Result of all files
+  static const char * const filenames[] =
+  {					// PPD files to test
+    "ppd/test4.ppd",
+    "ppd/test.ppd",
+    "ppd/test4.ppd",
+    "ppd/test2.ppd",
+    "ppd/test4.ppd"
+  };
+
+
+  files = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+
+  for (i = 0; i < (int)(sizeof(filenames) / sizeof(filenames[0])); i ++)
+  {
+    cupsArrayAdd(files, (void *)filenames[i]);
+
+    single = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+    cupsArrayAdd(single, (void *)filenames[i]);
+
+    if ((result = ppdTest(0, 0, NULL, 1, 0, 0, single, &expected, NULL,
+                          NULL)) < expected_result)
+      expected_result = result;
+
+    cupsArrayDelete(single);
+  }
+
+  fputs("ppdTest(cached probes): ", stdout);
+  report = NULL;
+  result = ppdTest(0, 0, NULL, 1, 0, 0, files, &report, NULL, NULL);
+  errors += !same_report(report, result, expected, expected_result);
+  cupsArrayDelete(report);
+
+  for (i = 2; i <= 6; i += 2)
+  {
+    printf("ppdTestFiles(jobs=%d): ", i);
+    report = NULL;
+    result = ppdTestFiles(0, 0, NULL, 1, 0, 0, files, i, &report, NULL, NULL);
+    errors += !same_report(report, result, expected, expected_result);
+    cupsArrayDelete(report);
+  }
+
+  cupsArrayDelete(expected);
+  cupsArrayDelete(files);
+
+  return (errors);
+}
+
+
+//
+// 'interpret_ppd()' - Mark options and create a page header.
+//
+
+static int				// O - 0 on success, -1 on error
+interpret_ppd(
+    ppd_file_t         *ppd,		// I - PPD file
+    const char         *options,	// I - Options to mark
+    cups_page_header_t *header)		// O - Page header
+{
+  int		num_options;		// Number of options
+  cups_option_t	*opts = NULL;		// Options
+
+
+  num_options = cupsParseOptions(options, 0, &opts);
+
+  ppdMarkDefaults(ppd);
+  ppdMarkOptions(ppd, num_options, opts);
+
+  cupsFreeOptions(num_options, opts);
+
+  return (ppdRasterInterpretPPD(header, ppd, 0, NULL, NULL));
+}
+
+
 //
 // 'print_changes()' - Print differences in the page header.
 //
@@ -1984,3 +2635,83 @@ print_changes(
            header->cupsPageSizeName,
            expected->cupsPageSizeName);
 }
+
+
+//
+// 'same_contents()' - Compare the contents of two files.
+//
+
+static int				// O - 1 if the same, 0 otherwise
+same_contents(const char *filename1,	// I - First file
+              const char *filename2)	// I - Second file
+{
+  cups_file_t	*fp1,			// First file
+		*fp2;			// Second file
+  int		ch1,			// Character from first file
+		ch2;			// Character from second file
+
+
+  fp1 = cupsFileOpen(filename1, "r");
+  fp2 = cupsFileOpen(filename2, "r");
+
+  if (fp1 && fp2)
+  {
+    do
+    {
+      ch1 = cupsFileGetChar(fp1);
+      ch2 = cupsFileGetChar(fp2);
+    }
+    while (ch1 == ch2 && ch1 != EOF);
+  }
+  else
+  {
+    ch1 = 0;
+    ch2 = 1;
+  }
+
+  if (fp1)
+    cupsFileClose(fp1);
+  if (fp2)
+    cupsFileClose(fp2);
+
+  return (ch1 == ch2);
+}
+
+
+//
+// 'same_report()' - Compare the report and result of a PPD test.
+//
+
+static int				// O - 1 if the same, 0 otherwise
+same_report(
+    cups_array_t *report,		// I - Report
+    int          result,		// I - Result
+    cups_array_t *expected,		// I - Expected report
+    int          expected_result)	// I - Expected result
+{
+  const char	*line,			// Report line
+		*expected_line;		// Expected report line
+
+
+  for (line = (const char *)cupsArrayGetFirst(report),
+           expected_line = (const char *)cupsArrayGetFirst(expected);
+       line && expected_line && !strcmp(line, expected_line);
+       line = (const char *)cupsArrayGetNext(report),
+           expected_line = (const char *)cupsArrayGetNext(expected));
+
+  if (result != expected_result)
+    printf("FAIL (result %d instead of %d)\n", result, expected_result);
+  else if (cupsArrayGetCount(report) != cupsArrayGetCount(expected))
+    printf("FAIL (%d report lines instead of %d)\n",
+	   cupsArrayGetCount(report), cupsArrayGetCount(expected));
+  else if (line || expected_line)
+    printf("FAIL (\"%s\" instead of \"%s\")\n",
+	   line ? line : "(null)", expected_line ? expected_line : "(null)");
+  else
+  {
+    printf("PASS (%d report lines)\n", cupsArrayGetCount(report));
+    return (1);
+  }
+
+  return (0);
+}
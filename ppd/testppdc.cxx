@@ -0,0 +1,237 @@
+//
+// PPD compiler tokenizer test program for libppd.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+//
+// Include necessary headers...
+//
+
+#include <ppd/ppdc-private.h>
+#include <ppd/libcups2-private.h>
+#include <unistd.h>
+
+
+//
+// Local types...
+//
+
+typedef struct test_token_s		// Expected token
+{
+  const char	*token;			// Token string
+  int		line;			// Line number after the token
+} test_token_t;
+
+
+//
+// Local functions...
+//
+
+static int	test_boundary(ppdcSource *src);
+static int	test_tokens(ppdcSource *src, const char *title, int pad,
+		            const char *text, const test_token_t *tokens,
+			    bool quiet);
+
+
+//
+// Test data...
+//
+
+static const test_token_t quote_tokens[] =
+{
+  { "Name", 1 },
+  { "Quoted String", 1 },
+  { "single \"inner\"", 1 },
+  { "back\"slash", 1 },
+  { "(paren \"q\" str)", 1 },
+  { "<41 42>", 1 },
+  { "{", 1 },
+  { "}", 1 },
+  { NULL, 2 }
+};
+static const char *quote_text =
+"Name \"Quoted String\" 'single \"inner\"' back\\\"slash (paren \"q\" str) <41 42> {}\n";
+
+static const test_token_t var_tokens[] =
+{
+  { "value", 1 },
+  { "a$b", 1 },
+  { "prevalue.post", 1 },
+  { "$", 1 },
+  { "valuevalue", 1 },
+  { "value here", 2 },
+  { NULL, 2 }
+};
+static const char *var_text =
+"$Var a$$b pre$Var.post $$ $Var$Var \"$Var here\"\n";
+
+static const test_token_t comment_tokens[] =
+{
+  { "one", 1 },
+  { "three", 2 },
+  { "six", 4 },
+  { "a/b", 5 },
+  { "multi\nline", 6 },
+  { "end", 7 },
+  { NULL, 7 }
+};
+static const char *comment_text =
+"one // comment two\n"
+"three /* four\n"
+"five */ six\n"
+"a/b\n"
+"\"multi\n"
+"line\" end\n";
+
+static const char *boundary_text =
+"straddling \"quoted\nstring\" \\\"escaped a$$b $Var // comment\nlast\n";
+
+
+//
+// 'main()' - Test the PPD compiler tokenizer.
+//
+
+int					// O - Exit status
+main(void)
+{
+  int		status = 0;		// Exit status
+  ppdcSource	*src;			// Source file for variables
+
+
+  src = new ppdcSource();
+  src->set_variable("Var", "value");
+
+  status += test_tokens(src, "get_token(quotes)", 0, quote_text, quote_tokens,
+                        false);
+  status += test_tokens(src, "get_token(variables)", 0, var_text, var_tokens,
+                        false);
+  status += test_tokens(src, "get_token(comments)", 0, comment_text,
+                        comment_tokens, false);
+  status += test_boundary(src);
+
+  src->release();
+
+  return (status);
+}
+
+
+//
+// 'test_boundary()' - Test tokens that are split across the file buffer.
+//
+// The text is preceded by enough newlines to move each of its tokens across
+// the end of the first 8k block read from the file.
+//
+
+static int				// O - Number of errors
+test_boundary(ppdcSource *src)		// I - Source file for variables
+{
+  int		pad;			// Number of newlines before text
+  test_token_t	tokens[7];		// Expected tokens
+
+
+  fputs("get_token(buffer boundary): ", stdout);
+
+  for (pad = 8100; pad <= 8200; pad ++)
+  {
+    tokens[0].token = "straddling";
+    tokens[0].line  = pad + 1;
+    tokens[1].token = "quoted\nstring";
+    tokens[1].line  = pad + 2;
+    tokens[2].token = "\"escaped";
+    tokens[2].line  = pad + 2;
+    tokens[3].token = "a$b";
+    tokens[3].line  = pad + 2;
+    tokens[4].token = "value";
+    tokens[4].line  = pad + 2;
+    tokens[5].token = "last";
+    tokens[5].line  = pad + 4;
+    tokens[6].token = NULL;
+    tokens[6].line  = pad + 4;
+
+    if (test_tokens(src, NULL, pad, boundary_text, tokens, true))
+    {
+      printf("FAIL (%d newlines before the text)\n", pad);
+      return (1);
+    }
+  }
+
+  puts("PASS");
+
+  return (0);
+}
+
+
+//
+// 'test_tokens()' - Compare the tokens read from a file.
+//
+
+static int				// O - 1 on error, 0 on success
+test_tokens(ppdcSource         *src,	// I - Source file for variables
+            const char         *title,	// I - Test title or NULL
+            int                pad,	// I - Newlines to write before text
+            const char         *text,	// I - Text to tokenize
+            const test_token_t *tokens,	// I - Expected tokens
+	    bool               quiet)	// I - Only report the result?
+{
+  int		status = 0;		// Return value
+  cups_file_t	*out;			// Temporary file
+  char		filename[1024],		// Temporary filename
+		buffer[256],		// Token buffer
+		*token;			// Token from file
+  ppdcFile	*fp;			// File to read
+
+
+  if (title)
+    printf("%s: ", title);
+
+  if ((out = cupsCreateTempFile(NULL, NULL, filename,
+                                sizeof(filename))) == NULL)
+  {
+    printf("FAIL (%s)\n", strerror(errno));
+    return (1);
+  }
+
+  for (; pad > 0; pad --)
+    cupsFilePutChar(out, '\n');
+
+  cupsFilePuts(out, text);
+  cupsFileClose(out);
+
+  fp = new ppdcFile(filename);
+
+  for (;; tokens ++)
+  {
+    token = src->get_token(fp, buffer, sizeof(buffer));
+
+    if (!token != !tokens->token || (token && strcmp(token, tokens->token)))
+    {
+      if (!quiet)
+        printf("FAIL (got \"%s\", expected \"%s\")\n",
+	       token ? token : "(null)",
+	       tokens->token ? tokens->token : "(null)");
+      status = 1;
+      break;
+    }
+    else if (fp->line != tokens->line)
+    {
+      if (!quiet)
+        printf("FAIL (line %d after \"%s\", expected %d)\n", fp->line,
+	       tokens->token ? tokens->token : "(null)", tokens->line);
+      status = 1;
+      break;
+    }
+
+    if (!token)
+      break;
+  }
+
+  delete fp;
+  unlink(filename);
+
+  if (!status && title)
+    puts("PASS");
+
+  return (status);
+}
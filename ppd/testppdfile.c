@@ -14,6 +14,7 @@
 #include <string.h>
 #include <cups/array.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 
 //
@@ -29,6 +30,7 @@ usage()
   fprintf(stderr, "-I {filename, filters, none, profiles}\n"
 	          "                        Ignore specific warnings\n");
   fprintf(stderr, "-R root-directory       Set alternate root\n");
+  fprintf(stderr, "-j jobs                 Test with this many processes\n");
   fprintf(stderr, "-W {all, none, constraints, defaults, duplex, filters,\n"
 	          "    profiles, sizes, translations}\n"
 	          "                        Issue warnings instead of errors\n");
@@ -56,6 +58,7 @@ int main(int argc,     // I - Number of command-line args
   int help = 0;                    // Whether to run help dialog
   char *opt;                       // Option character
   int relaxed = 0;                 // If relaxed mode is to be used
+  int jobs = 1;                    // Number of test processes
   cups_array_t *file_array;        // Array consisting of filenames of the ppd
                                    // files to be checked
   int files = 0;                   // Number of files
@@ -106,6 +109,13 @@ int main(int argc,     // I - Number of command-line args
 	      root_present = 1;
 	      break;
 
+          case 'j':  // Number of test processes
+              i ++;
+
+	      if (i >= argc || (jobs = atoi(argv[i])) < 1)
+		help = 1;
+	      break;
+
           case 'W':  // Turn errors into warn_paramsings
               i ++;
 
@@ -167,8 +177,8 @@ int main(int argc,     // I - Number of command-line args
     return (0);
   }
 
-  result = ppdTest(ignore, warn, rootdir, verbose, relaxed, root_present,
-		   file_array, &report, NULL, NULL);
+  result = ppdTestFiles(ignore, warn, rootdir, verbose, relaxed, root_present,
+			file_array, jobs, &report, NULL, NULL);
 
   if (result == 1 && files > 0) puts("PPD PASSED");
   else if (result == 0) puts("PPD FAILED");